@@ -2,45 +2,88 @@
 #include "imgui_graphnode_internal.h"
 #include "imgui_internal.h"
 
-static float IsPointInRectangle_IsLeft(ImVec2 const & p0, ImVec2 const & p1, ImVec2 const & p2)
+#include <chrono>
+
+ImGuiGraphNodeContext * IMGUI_GRAPHNODE_NAMESPACE::CreateContext()
 {
-    return (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+    ImGuiGraphNodeContext * const ctx = IM_NEW(ImGuiGraphNodeContext)();
+
+    ctx->gvcontext = ImGuiGraphNode_CreateGraphvizContext();
+    if (GImGuiGraphNode == nullptr)
+        SetCurrentContext(ctx);
+    return ctx;
 }
 
-static bool IsPointInRectangle(ImVec2 const & a, ImVec2 const & b, ImVec2 const & c, ImVec2 const & d, ImVec2 const & p)
+void IMGUI_GRAPHNODE_NAMESPACE::DestroyContext(ImGuiGraphNodeContext * ctx)
 {
-    return IsPointInRectangle_IsLeft(a, b, p) > 0
-        && IsPointInRectangle_IsLeft(b, c, p) > 0
-        && IsPointInRectangle_IsLeft(c, d, p) > 0
-        && IsPointInRectangle_IsLeft(d, a, p) > 0;
+    ImGuiGraphNodeContext * const prev_ctx = GImGuiGraphNode;
+
+    if (ctx == nullptr)
+        ctx = prev_ctx;
+    IM_ASSERT(ctx != nullptr);
+    ImGuiGraphNodeStopLayoutWorker(*ctx);
+    ctx->graph_caches.clear();
+    ImGuiGraphNode_FreeGraphvizContext(ctx->gvcontext);
+    if (prev_ctx == ctx)
+        SetCurrentContext(nullptr);
+    IM_DELETE(ctx);
 }
 
-void IMGUI_GRAPHNODE_NAMESPACE::CreateContext()
+ImGuiGraphNodeContext * IMGUI_GRAPHNODE_NAMESPACE::GetCurrentContext()
 {
-    IM_ASSERT(g_ctx.gvcontext == nullptr);
-    g_ctx.gvcontext = gvContext();
+    return GImGuiGraphNode;
 }
 
-void IMGUI_GRAPHNODE_NAMESPACE::DestroyContext()
+void IMGUI_GRAPHNODE_NAMESPACE::SetCurrentContext(ImGuiGraphNodeContext * ctx)
 {
-    IM_ASSERT(g_ctx.gvcontext != nullptr);
-    gvFreeContext(g_ctx.gvcontext);
-    g_ctx.gvcontext = nullptr;
+    GImGuiGraphNode = ctx;
 }
 
-bool IMGUI_GRAPHNODE_NAMESPACE::BeginNodeGraph(char const * id, ImGuiGraphNodeLayout layout, float pixel_per_unit)
+// Caches are collected once per frame, before the first graph is submitted.
+// Submissions of the previous frame are done with, their arena is reset.
+static ImGuiGraphNodeContextCache & ImGuiGraphNodeGetCache(ImGuiGraphNodeContext & ctx, ImGuiID id)
 {
-    g_ctx.lastid = ImGui::GetID(id);
-    auto & cache = g_ctx.graph_caches[g_ctx.lastid];
-    IM_ASSERT(g_ctx.gvgraph == nullptr);
-    IM_ASSERT(cache.graphid_current.empty());
-    g_ctx.gvgraph = agopen(const_cast<char *>("g"), Agdirected, 0);
-    cache.layout = layout;
+    int const frame = ImGui::GetFrameCount();
+
+    if (ctx.cache_gc_frame != frame)
+    {
+        size_t const allocations = GImGuiGraphNodeAllocations.allocations.load(std::memory_order_relaxed);
+
+        ctx.frame_allocations = allocations - ctx.frame_allocations_start;
+        ctx.frame_allocations_start = allocations;
+        ctx.cache_gc_frame = frame;
+        ctx.frame_arena.Reset();
+        ImGuiGraphNodeCollectCaches(ctx, frame);
+    }
+
+    auto & cache = ctx.graph_caches[id];
+
+    cache.last_frame = frame;
+    return cache;
+}
+
+bool IMGUI_GRAPHNODE_NAMESPACE::BeginNodeGraph(char const * id, ImGuiGraphNodeLayout layout, float pixel_per_unit, ImGuiGraphNodeFlags flags)
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+
+    ctx.lastid = ImGui::GetID(id);
+    auto & cache = ImGuiGraphNodeGetCache(ctx, ctx.lastid);
+    IM_ASSERT(cache.graphid_current == 0);
+    cache.submission.Reset(&ctx.frame_arena);
+    cache.submission.layout = layout;
+    cache.flags = flags;
     cache.pixel_per_unit = pixel_per_unit;
+    cache.cursor = ImGui::GetCursorScreenPos();
+
+    // Hover is resolved once here for the whole graph, items only compare ids
+    ImVec2 const mouse_pos(ImGui::GetIO().MousePos.x - cache.cursor.x, ImGui::GetIO().MousePos.y - cache.cursor.y);
+    ImGuiGraphNode_HitItem const * const hovered = cache.hitgrid.Query(mouse_pos);
 
-    char graphid_buf[16] = { 0 };
-    snprintf(graphid_buf, sizeof(graphid_buf) - 1, "%d", (int)layout);
-    cache.graphid_current += graphid_buf;
+    cache.hovered_id = hovered ? hovered->id : 0;
+    cache.hovered_bb = hovered ? hovered->bb : ImRect();
+    cache.hovered_bb.Translate(cache.cursor);
+
+    ImGuiGraphNode_HashGraphId(cache, &layout, sizeof(layout));
 
     return true;
 }
@@ -54,25 +97,30 @@ void IMGUI_GRAPHNODE_NAMESPACE::NodeGraphAddNode(char const * id)
 
 void IMGUI_GRAPHNODE_NAMESPACE::NodeGraphAddNode(char const * id, ImVec4 const & color, ImVec4 const & fillcolor)
 {
-    auto & cache = g_ctx.graph_caches[g_ctx.lastid];
-    IM_ASSERT(g_ctx.gvgraph != nullptr);
-    Agnode_t * const n = agnode(g_ctx.gvgraph, ImGuiIDToString(id), 1);
-    IM_ASSERT(n != nullptr);
-    IMGUI_GRAPHNODE_CREATE_LABEL_ALLOCA(text, id);
-    auto const color_str = ImVec4ColorToString(color);
-    auto const fillcolor_str = ImVec4ColorToString(fillcolor);
-    agsafeset(n, (char *)"label", text, "");
-    agsafeset(n, (char *)"color", color_str, "");
-    agsafeset(n, (char *)"fillcolor", fillcolor_str, "");
-
-    cache.graphid_current += id;
-    cache.graphid_current += color_str;
-    cache.graphid_current += fillcolor_str;
-
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+    auto & cache = ctx.graph_caches[ctx.lastid];
     ImGuiID const imid = ImGui::GetID(id);
-    auto const it = cache.graph.nodesBB.find(imid);
-    ImRect const bb = it != cache.graph.nodesBB.end() ? it->second : ImRect();
-    ImGui::ItemAdd(bb, imid);
+    ImGuiGraphNode_SubmittedNode node;
+
+    node.id = imid;
+    node.label = cache.submission.AddString(id, ImGui::FindRenderedTextEnd(id));
+    node.color = ImGui::ColorConvertFloat4ToU32(color);
+    node.fillcolor = ImGui::ColorConvertFloat4ToU32(fillcolor);
+    cache.submission.nodes.push_back(node);
+
+    ImGuiGraphNode_HashGraphId(cache, id, strlen(id) + 1);
+    ImGuiGraphNode_HashGraphId(cache, &node.color, sizeof(node.color));
+    ImGuiGraphNode_HashGraphId(cache, &node.fillcolor, sizeof(node.fillcolor));
+
+    if (imid == cache.hovered_id)
+    {
+        ImGui::ItemAdd(cache.hovered_bb, imid);
+        GImGui->LastItemData.StatusFlags |= ImGuiItemStatusFlags_HoveredRect;
+    }
+    else
+    {
+        ImGui::ItemAdd(ImRect(), imid);
+    }
 }
 
 void IMGUI_GRAPHNODE_NAMESPACE::NodeGraphAddEdge(char const * id, char const * node_id_a, char const * node_id_b)
@@ -83,205 +131,847 @@ void IMGUI_GRAPHNODE_NAMESPACE::NodeGraphAddEdge(char const * id, char const * n
 
 void IMGUI_GRAPHNODE_NAMESPACE::NodeGraphAddEdge(char const * id, char const * node_id_a, char const * node_id_b, ImVec4 const & color)
 {
-    auto & cache = g_ctx.graph_caches[g_ctx.lastid];
-    IM_ASSERT(g_ctx.gvgraph != nullptr);
-    Agnode_t * const a = agnode(g_ctx.gvgraph, ImGuiIDToString(node_id_a), 0);
-    Agnode_t * const b = agnode(g_ctx.gvgraph, ImGuiIDToString(node_id_b), 0);
-    IM_ASSERT(a != nullptr);
-    IM_ASSERT(b != nullptr);
-    Agedge_t * const e = agedge(g_ctx.gvgraph, a, b, ImGuiIDToString(id), 1);
-    IM_ASSERT(e != nullptr);
-    IMGUI_GRAPHNODE_CREATE_LABEL_ALLOCA(text, id);
-    auto const color_str = ImVec4ColorToString(color);
-    agsafeset(e, (char *)"label", text, "");
-    ImGuiID const imid = ImGui::GetID(id, ImGui::FindRenderedTextEnd(id));
-    char identifier[16];
-    sprintf(identifier, "#%x", imid);
-    // graphviz library doesn't serialize the edge's identifier, so we use the
-    // color field to store the ImGuiID, which will later be used to retrieve
-    // the edge's properties.
-    agsafeset(e, (char *)"color", identifier, "");
-    cache.edgeIdToInfo[imid] = ImGuiGraphNode_EdgeInfo { ImGui::GetColorU32(color) };
-
-    cache.graphid_current += id;
-    cache.graphid_current += node_id_a;
-    cache.graphid_current += node_id_b;
-    cache.graphid_current += color_str;
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+    auto & cache = ctx.graph_caches[ctx.lastid];
+    char const * const text_end = ImGui::FindRenderedTextEnd(id);
+    ImGuiID const imid = ImGui::GetID(id, text_end);
+    ImGuiGraphNode_SubmittedEdge edge;
+
+    edge.id = imid;
+    edge.name = ImGui::GetID(id);
+    edge.tail = ImGui::GetID(node_id_a);
+    edge.head = ImGui::GetID(node_id_b);
+    edge.label = cache.submission.AddString(id, text_end);
+    edge.color = ImGui::GetColorU32(color);
+    cache.submission.edges.push_back(edge);
+
+    ImGuiGraphNode_HashGraphId(cache, id, strlen(id) + 1);
+    ImGuiGraphNode_HashGraphId(cache, node_id_a, strlen(node_id_a) + 1);
+    ImGuiGraphNode_HashGraphId(cache, node_id_b, strlen(node_id_b) + 1);
+    ImGuiGraphNode_HashGraphId(cache, &edge.color, sizeof(edge.color));
 
     ImGui::ItemAdd(ImRect(), imid);
-    auto const it = cache.graph.edgesRectangle.find(imid);
-    if (it != cache.graph.edgesRectangle.end())
+    if (imid == cache.hovered_id)
+        GImGui->LastItemData.StatusFlags |= ImGuiItemStatusFlags_HoveredRect;
+}
+
+// Bulk submissions only add the hovered element as an ImGui item
+static void ImGuiGraphNodeAddHoveredItem(ImGuiGraphNodeContextCache const & cache)
+{
+    ImGui::ItemAdd(cache.hovered_bb, cache.hovered_id);
+    GImGui->LastItemData.StatusFlags |= ImGuiItemStatusFlags_HoveredRect;
+}
+
+int IMGUI_GRAPHNODE_NAMESPACE::NodeGraphAddNodes(char const * const * ids, int count, ImU32 const * colors, ImU32 const * fillcolors)
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+    auto & cache = ctx.graph_caches[ctx.lastid];
+    ImGuiGraphNode_Submission & submission = cache.submission;
+    ImGuiID const seed = GImGui->CurrentWindow->IDStack.back();
+    ImU32 const color = ImGui::ColorConvertFloat4ToU32(ImGui::GetStyle().Colors[ImGuiCol_Text]);
+    size_t const first = submission.nodes.size();
+    int hovered = -1;
+
+    submission.nodes.resize(first + count);
+    for (int i = 0; i < count; ++i)
     {
-        for (auto const & rect : it->second)
-        {
-            // Uncomment to draw edge bouding boxes
-            //ImVec2 lines[] { rect.a, rect.b, rect.c, rect.d };
-            //ImGui::GetWindowDrawList()->AddPolyline(lines, 4, IM_COL32(255, 0, 0, 255), ImDrawFlags_Closed, 2.0f);
+        ImGuiGraphNode_SubmittedNode & node = submission.nodes[first + i];
+
+        node.id = ImHashStr(ids[i], 0, seed);
+        node.label = submission.AddString(ids[i], ImGui::FindRenderedTextEnd(ids[i]));
+        node.color = colors ? colors[i] : color;
+        node.fillcolor = fillcolors ? fillcolors[i] : 0;
+        if (node.id == cache.hovered_id)
+            hovered = i;
+        ImGuiGraphNode_HashGraphId(cache, ids[i], strlen(ids[i]) + 1);
+        ImGuiGraphNode_HashGraphId(cache, &node.color, sizeof(node.color));
+        ImGuiGraphNode_HashGraphId(cache, &node.fillcolor, sizeof(node.fillcolor));
+    }
+    if (hovered >= 0)
+        ImGuiGraphNodeAddHoveredItem(cache);
+    return hovered;
+}
 
-            if (IsPointInRectangle(rect.a, rect.b, rect.c, rect.d, ImGui::GetIO().MousePos))
-            {
-                GImGui->LastItemData.StatusFlags |= ImGuiItemStatusFlags_HoveredRect;
-                break;
-            }
+int IMGUI_GRAPHNODE_NAMESPACE::NodeGraphAddEdges(char const * const * ids, char const * const * node_ids_a, char const * const * node_ids_b, int count, ImU32 const * colors)
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+    auto & cache = ctx.graph_caches[ctx.lastid];
+    ImGuiGraphNode_Submission & submission = cache.submission;
+    ImGuiID const seed = GImGui->CurrentWindow->IDStack.back();
+    ImU32 const color = ImGui::GetColorU32(ImGui::GetStyle().Colors[ImGuiCol_Text]);
+    size_t const first = submission.edges.size();
+    int hovered = -1;
+
+    submission.edges.resize(first + count);
+    for (int i = 0; i < count; ++i)
+    {
+        ImGuiGraphNode_SubmittedEdge & edge = submission.edges[first + i];
+        char const * const text_end = ImGui::FindRenderedTextEnd(ids[i]);
+
+        edge.id = ImHashStr(ids[i], text_end - ids[i], seed);
+        edge.name = ImHashStr(ids[i], 0, seed);
+        edge.tail = ImHashStr(node_ids_a[i], 0, seed);
+        edge.head = ImHashStr(node_ids_b[i], 0, seed);
+        edge.label = submission.AddString(ids[i], text_end);
+        edge.color = colors ? colors[i] : color;
+        if (edge.id == cache.hovered_id)
+            hovered = i;
+        ImGuiGraphNode_HashGraphId(cache, ids[i], strlen(ids[i]) + 1);
+        ImGuiGraphNode_HashGraphId(cache, node_ids_a[i], strlen(node_ids_a[i]) + 1);
+        ImGuiGraphNode_HashGraphId(cache, node_ids_b[i], strlen(node_ids_b[i]) + 1);
+        ImGuiGraphNode_HashGraphId(cache, &edge.color, sizeof(edge.color));
+    }
+    if (hovered >= 0)
+        ImGuiGraphNodeAddHoveredItem(cache);
+    return hovered;
+}
+
+int IMGUI_GRAPHNODE_NAMESPACE::NodeGraphAddEdges(char const * const * node_ids, int count, int const * offsets, int const * targets, ImU32 const * colors)
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+    auto & cache = ctx.graph_caches[ctx.lastid];
+    ImGuiGraphNode_Submission & submission = cache.submission;
+    ImGuiID const seed = GImGui->CurrentWindow->IDStack.back();
+    ImU32 const color = ImGui::GetColorU32(ImGui::GetStyle().Colors[ImGuiCol_Text]);
+    int const edge_count = offsets[count] - offsets[0];
+    size_t const first = submission.edges.size();
+    int const label = submission.AddString("", "");
+    ImGuiGraphNode_Vector<ImGuiID> node_imids(count, 0, ImGuiGraphNode_Allocator<ImGuiID>(&ctx.frame_arena)); // reset with the submission
+    int hovered = -1;
+
+    for (int i = 0; i < count; ++i)
+        node_imids[i] = ImHashStr(node_ids[i], 0, seed);
+    submission.edges.resize(first + edge_count);
+    for (int i = 0; i < count; ++i)
+    {
+        for (int j = offsets[i]; j < offsets[i + 1]; ++j)
+        {
+            ImGuiGraphNode_SubmittedEdge & edge = submission.edges[first + j - offsets[0]];
+
+            // Without a label, the edge is named after its tail and its head
+            // so that it keeps its id when other edges are inserted
+            edge.name = ImHashData(&node_imids[targets[j]], sizeof(ImGuiID), node_imids[i]);
+            edge.id = edge.name;
+            edge.tail = node_imids[i];
+            edge.head = node_imids[targets[j]];
+            edge.label = label;
+            edge.color = colors ? colors[j] : color;
+            if (edge.id == cache.hovered_id)
+                hovered = j;
+            ImGuiGraphNode_HashGraphId(cache, "", 1);
+            ImGuiGraphNode_HashGraphId(cache, node_ids[i], strlen(node_ids[i]) + 1);
+            ImGuiGraphNode_HashGraphId(cache, node_ids[targets[j]], strlen(node_ids[targets[j]]) + 1);
+            ImGuiGraphNode_HashGraphId(cache, &edge.color, sizeof(edge.color));
         }
     }
+    if (hovered >= 0)
+        ImGuiGraphNodeAddHoveredItem(cache);
+    return hovered;
 }
 
-int ImGuiGraphNodeFillDrawNodeBuffer(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_DrawNode * drawnodes, ImVec2 cursor_pos, float ppu)
+// Draw buffers are expressed in pixels relative to the graph's top left
+// corner, so that moving the graph on screen doesn't require filling them
+// again. The screen offset is only applied when emitting draw commands.
+// Outlines are the unit circle table at each node's level of detail: levels
+// are picked and points allocated first, then all outlines are scaled and
+// translated in one pass.
+int ImGuiGraphNodeFillDrawNodeBuffer(ImGuiGraphNode_Graph const & graph, ImVec2 const * textsizes, ImGuiGraphNode_DrawNode * drawnodes, ImGuiGraphNode_NoInitVector<ImVec2> & drawpoints, ImGuiGraphNode_HitGrid & hitgrid, float ppu)
 {
-    int const count = (int)graph.nodes.size();
+    int const count = graph.GetNodeCount();
 
     if (drawnodes)
     {
-        constexpr int num_segments = IMGUI_GRAPHNODE_DRAW_NODE_PATH_COUNT - 1;
-        static_assert(num_segments > 0, "");
-        float a_min = 0.f;
-        float a_max = (IM_PI * 2.0f) * ((float)num_segments - 1.0f) / (float)num_segments;
+        ImGuiGraphNode_EllipseTable const & table = ImGuiGraphNode_GetEllipseTable();
+        float lod_radii[IMGUI_GRAPHNODE_DRAW_NODE_LOD_COUNT];
+        int path_offset = (int)drawpoints.size();
 
+        ImGuiGraphNode_CalcEllipseLodRadii(ImGui::GetStyle().CircleTessellationMaxError, lod_radii);
         for (int i = 0; i < count; ++i)
         {
-            ImGuiGraphNode_Node const & node = graph.nodes[i];
-            ImVec2 const textsize = ImGui::CalcTextSize(node.label.c_str());
+            ImVec2 const size = graph.node_sizes[i];
+            float const radius = ImMax(size.x, size.y) / 2.f * ppu;
+            int lod = 0;
+
+            while (radius > lod_radii[lod])
+                ++lod;
+            drawnodes[i].path_offset = path_offset;
+            drawnodes[i].path_count = IMGUI_GRAPHNODE_DRAW_NODE_PATH_MIN_COUNT << lod;
+            path_offset += drawnodes[i].path_count;
+        }
+        drawpoints.resize(path_offset);
+        hitgrid.items.resize(hitgrid.items.size() + count);
 
-            for (int j = 0; j <= num_segments; j++)
-            {
-                const float a = a_min + ((float)j / (float)num_segments) * (a_max - a_min);
-                drawnodes[i].path[j].x = cursor_pos.x + (node.pos.x + ImCos(a) * node.size.x / 2.f) * ppu;
-                drawnodes[i].path[j].y = cursor_pos.y + ((graph.size.y - node.pos.y) + ImSin(a) * node.size.y / 2.f) * ppu;
-            }
-            drawnodes[i].textpos.x = cursor_pos.x + node.pos.x * ppu - textsize.x / 2.f;
-            drawnodes[i].textpos.y = cursor_pos.y + (graph.size.y - node.pos.y) * ppu - textsize.y / 2.f;
-            drawnodes[i].text = node.label.c_str();
-            drawnodes[i].color = node.color;
-            drawnodes[i].fillcolor = node.fillcolor;
-
-            ImRect const bb(
-                cursor_pos.x + (node.pos.x - node.size.x / 2.f) * ppu,
-                cursor_pos.y + ((graph.size.y - node.pos.y) - node.size.y / 2.f) * ppu,
-                cursor_pos.x + (node.pos.x + node.size.x / 2.f) * ppu,
-                cursor_pos.y + ((graph.size.y - node.pos.y) + node.size.y / 2.f) * ppu
-            );
-            ImGuiID const imid = atol(node.name.c_str());
-            graph.nodesBB[imid] = bb;
+        ImGuiGraphNode_HitItem * const hititems = hitgrid.items.data() + hitgrid.items.size() - count;
+
+        for (int i = 0; i < count; ++i)
+        {
+            ImGuiGraphNode_DrawNode & drawnode = drawnodes[i];
+            ImVec2 const pos = graph.node_pos[i];
+            ImVec2 const size = graph.node_sizes[i];
+            ImVec2 const center(pos.x * ppu, (graph.size.y - pos.y) * ppu);
+            ImVec2 const radius(size.x / 2.f * ppu, size.y / 2.f * ppu);
+            ImVec2 const textsize = textsizes[i];
+
+            ImGuiGraphNode_TransformPoints(table.GetPoints(drawnode.path_count), drawnode.path_count, center, radius, drawpoints.data() + drawnode.path_offset);
+            drawnode.textpos.x = center.x - textsize.x / 2.f;
+            drawnode.textpos.y = center.y - textsize.y / 2.f;
+            drawnode.text = graph.GetString(graph.node_labels[i]);
+            drawnode.color = graph.node_colors[i];
+            drawnode.fillcolor = graph.node_fillcolors[i];
+
+            ImRect const bb(center.x - radius.x, center.y - radius.y, center.x + radius.x, center.y + radius.y);
+
+            hititems[i].bb = bb;
+            hititems[i].id = graph.node_ids[i];
+            hititems[i].node = true;
+            drawnode.bb = bb;
+            drawnode.bb.Add(ImRect(drawnode.textpos, ImVec2(drawnode.textpos.x + textsize.x, drawnode.textpos.y + textsize.y)));
+            drawnode.bb.Expand(1.f); // anti-aliasing fringe
         }
     }
     return count;
 }
 
-int ImGuiGraphNodeFillDrawEdgeBuffer(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_DrawEdge * drawedges, ImVec2 cursor_pos, float ppu)
+// Edges are filled in two passes: the first one sizes every path and
+// allocates the draw points and hit items of all edges, the second one
+// writes each edge's hit quads, path and arrow. Every edge writes to its own
+// ranges, so the second pass can be split over threads.
+int ImGuiGraphNodeFillDrawEdgeBuffer(ImGuiGraphNode_Graph const & graph, ImVec2 const * textsizes, ImGuiGraphNode_DrawEdge * drawedges, ImGuiGraphNode_NoInitVector<ImVec2> & drawpoints, ImGuiGraphNode_HitGrid & hitgrid, float ppu, int num_threads)
 {
-    int const count = (int)graph.edges.size();
+    int const count = graph.GetEdgeCount();
 
     if (drawedges)
     {
-        constexpr int points_count = IMGUI_GRAPHNODE_DRAW_EDGE_PATH_COUNT;
-        static_assert(points_count > 1, "");
+        float const tol = ImGui::GetStyle().CurveTessellationTol;
+        int path_offset = (int)drawpoints.size();
 
         for (int i = 0; i < count; ++i)
         {
-            ImGuiGraphNode_Edge const & edge = graph.edges[i];
-            ImVec2 const textsize = ImGui::CalcTextSize(edge.label.c_str());
+            drawedges[i].path_offset = path_offset;
+            drawedges[i].path_count = ImGuiGraphNode_CountSplineSamples(graph.GetEdgePoints(i), graph.GetEdgePointCount(i), ppu, tol);
+            path_offset += drawedges[i].path_count;
+        }
+        drawpoints.resize(path_offset);
+        // One hit quad per control polygon segment: edge i's quads start at
+        // its first control point minus the i points that start no segment
+        int const hit_count = (int)graph.points.size() - count;
 
-            for (size_t j = 0; j < (edge.points.size() - 1); ++j)
-            {
-                ImVec2 const p1(
-                    cursor_pos.x + edge.points[j].x * ppu,
-                    cursor_pos.y + (graph.size.y - edge.points[j].y) * ppu
-                );
-                ImVec2 const p2(
-                    cursor_pos.x + edge.points[j + 1].x * ppu,
-                    cursor_pos.y + (graph.size.y - edge.points[j + 1].y) * ppu
-                );
-                ImVec2 const dir(p2.x - p1.x, p2.y - p1.y);
-                ImVec2 left(-dir.y, dir.x);
-                ImVec2 right(dir.y, -dir.x);
-                float const magLeft = ImSqrt(left.x * left.x + left.y * left.y);
-                float const magRight = ImSqrt(right.x * right.x + right.y * right.y);
-
-                left.x /= magLeft;
-                left.y /= magLeft;
-                right.x /= magRight;
-                right.y /= magRight;
-
-                constexpr float k = 3.f;
-                ImVec2 const a(p1.x + left.x * k, p1.y + left.y * k);
-                ImVec2 const b(p1.x + right.x * k, p1.y + right.y * k);
-                ImVec2 const c(p2.x + right.x * k, p2.y + right.y * k);
-                ImVec2 const d(p2.x + left.x * k, p2.y + left.y * k);
-
-                graph.edgesRectangle[edge.id].push_back({ a, b, c, d });
-            }
-            for (int x = 0; x < points_count; ++x)
+        hitgrid.items.resize(hitgrid.items.size() + hit_count);
+
+        ImGuiGraphNode_HitItem * const hititems = hitgrid.items.data() + hitgrid.items.size() - hit_count;
+        ImVec2 * const points_out = drawpoints.data();
+        ImVec2 const scale(ppu, -ppu);
+        ImVec2 const offset(0.f, graph.size.y * ppu);
+
+        if (num_threads <= 0)
+            num_threads = ImMax((int)std::thread::hardware_concurrency(), 1);
+        ImGuiGraphNode_ParallelFor(count, num_threads, [&](int begin, int end, int)
+        {
+            for (int i = begin; i < end; ++i)
             {
-                drawedges[i].path[x] = ImGuiGraphNode_BezierVec2(edge.points.data(), (int)edge.points.size(), x / float(points_count - 1));
-                drawedges[i].path[x].y = graph.size.y - drawedges[i].path[x].y;
-                drawedges[i].path[x].x *= ppu;
-                drawedges[i].path[x].y *= ppu;
-                drawedges[i].path[x].x += cursor_pos.x;
-                drawedges[i].path[x].y += cursor_pos.y;
+                ImGuiGraphNode_DrawEdge & drawedge = drawedges[i];
+                ImVec2 const * const points = graph.GetEdgePoints(i);
+                int const point_count = graph.GetEdgePointCount(i);
+                ImGuiGraphNode_HitItem * const hits = hititems + graph.edge_points[i] - i;
+                ImGuiID const id = graph.edge_ids[i];
+                ImVec2 p2(offset.x + points[0].x * scale.x, offset.y + points[0].y * scale.y);
+
+                for (int j = 0; j < point_count - 1; ++j)
+                {
+                    ImVec2 const p1 = p2;
+
+                    p2 = ImVec2(offset.x + points[j + 1].x * scale.x, offset.y + points[j + 1].y * scale.y);
+
+                    ImVec2 const dir(p2.x - p1.x, p2.y - p1.y);
+                    float const mag = ImSqrt(dir.x * dir.x + dir.y * dir.y);
+                    constexpr float k = 3.f;
+                    float const n = mag > 0.f ? k / mag : 0.f;
+                    ImVec2 const left(-dir.y * n, dir.x * n);
+                    ImGuiGraphNode_HitItem & hit = hits[j];
+
+                    hit.rect.a = ImVec2(p1.x + left.x, p1.y + left.y);
+                    hit.rect.b = ImVec2(p1.x - left.x, p1.y - left.y);
+                    hit.rect.c = ImVec2(p2.x - left.x, p2.y - left.y);
+                    hit.rect.d = ImVec2(p2.x + left.x, p2.y + left.y);
+                    hit.bb = ImRect(
+                        ImMin(p1.x, p2.x) - ImFabs(left.x), ImMin(p1.y, p2.y) - ImFabs(left.y),
+                        ImMax(p1.x, p2.x) + ImFabs(left.x), ImMax(p1.y, p2.y) + ImFabs(left.y)
+                    );
+                    hit.id = id;
+                    hit.node = false;
+                }
+
+                ImVec2 * const path = points_out + drawedge.path_offset;
+                int const path_count = drawedge.path_count;
+                ImVec2 const textsize = textsizes[i];
+                char const * const label = graph.GetString(graph.edge_labels[i]);
+
+                ImGuiGraphNode_TessellateSplineAdaptive(points, point_count, scale, offset, tol, path);
+                drawedge.textpos.x = graph.edge_label_pos[i].x * ppu - textsize.x / 2.f;
+                drawedge.textpos.y = (graph.size.y - graph.edge_label_pos[i].y) * ppu - textsize.y / 2.f;
+                drawedge.text = label;
+                drawedge.color = graph.edge_colors[i];
+
+                ImVec2 const lastpoint = path[path_count - 1];
+                float dirx = lastpoint.x - path[path_count - 2].x;
+                float diry = lastpoint.y - path[path_count - 2].y;
+                float const mag = ImSqrt(dirx * dirx + diry * diry);
+                float const inv = mag > 0.f ? 1.f / mag : 0.f;
+                float const mul1 = ppu * 0.1f;
+                float const mul2 = ppu * 0.0437f;
+
+                dirx *= inv;
+                diry *= inv;
+                drawedge.arrow1.x = lastpoint.x - dirx * mul1 - diry * mul2;
+                drawedge.arrow1.y = lastpoint.y - diry * mul1 + dirx * mul2;
+                drawedge.arrow2.x = lastpoint.x - dirx * mul1 + diry * mul2;
+                drawedge.arrow2.y = lastpoint.y - diry * mul1 - dirx * mul2;
+                drawedge.arrow3 = lastpoint;
+
+                ImRect bb = ImGuiGraphNode_CalcBounds(path, path_count);
+
+                bb.Add(drawedge.arrow1);
+                bb.Add(drawedge.arrow2);
+                if (*label != '\0')
+                {
+                    bb.Add(ImRect(drawedge.textpos, ImVec2(drawedge.textpos.x + textsize.x, drawedge.textpos.y + textsize.y)));
+                }
+                bb.Expand(1.f); // anti-aliasing fringe
+                drawedge.bb = bb;
             }
-            drawedges[i].textpos.x = cursor_pos.x + edge.labelPos.x * ppu - textsize.x / 2.f;
-            drawedges[i].textpos.y = cursor_pos.y + (graph.size.y - edge.labelPos.y) * ppu - textsize.y / 2.f;
-            drawedges[i].text = edge.label.c_str();
-            drawedges[i].color = edge.color;
-
-            ImVec2 const lastpoint = drawedges[i].path[points_count - 1];
-            float dirx = lastpoint.x - drawedges[i].path[points_count - 2].x;
-            float diry = lastpoint.y - drawedges[i].path[points_count - 2].y;
-            float const mag = ImSqrt(dirx * dirx + diry * diry);
-            float const mul1 = ppu * 0.1f;
-            float const mul2 = ppu * 0.0437f;
-
-            dirx /= mag;
-            diry /= mag;
-            drawedges[i].arrow1.x = lastpoint.x - dirx * mul1 - diry * mul2;
-            drawedges[i].arrow1.y = lastpoint.y - diry * mul1 + dirx * mul2;
-            drawedges[i].arrow2.x = lastpoint.x - dirx * mul1 + diry * mul2;
-            drawedges[i].arrow2.y = lastpoint.y - diry * mul1 - dirx * mul2;
-            drawedges[i].arrow3 = lastpoint;
-        }
+        }, IMGUI_GRAPHNODE_DRAW_EDGES_PER_THREAD);
     }
     return count;
 }
 
-void IMGUI_GRAPHNODE_NAMESPACE::EndNodeGraph()
+// Label sizes only depend on the labels and the font, they are kept when
+// the buffers are filled again for a zoom or a progressive layout step.
+static void ImGuiGraphNodeMeasureLabels(ImGuiGraphNodeContextCache & cache)
+{
+    ImGuiGraphNode_Graph const & graph = cache.graph;
+    int const node_count = graph.GetNodeCount();
+    int const edge_count = graph.GetEdgeCount();
+
+    cache.textsizes.resize(node_count + edge_count);
+    for (int i = 0; i < node_count; ++i)
+        cache.textsizes[i] = ImGui::CalcTextSize(graph.GetString(graph.node_labels[i]));
+    for (int i = 0; i < edge_count; ++i)
+        cache.textsizes[node_count + i] = ImGui::CalcTextSize(graph.GetString(graph.edge_labels[i]));
+    cache.textsizes_font = ImGui::GetFont();
+    cache.textsizes_font_size = ImGui::GetFontSize();
+    cache.textsizes_dirty = false;
+}
+
+// Runs iterations until the frame budget is spent, at least one so that the
+// layout always makes progress, then publishes the current positions.
+static void ImGuiGraphNodeStepProgressiveLayout(ImGuiGraphNodeContext & ctx, ImGuiGraphNodeContextCache & cache, ImGuiGraphNode_Submission const & submission)
+{
+    ImGuiGraphNode_ForceLayout & layout = *cache.progressive;
+    auto const start = std::chrono::steady_clock::now();
+    std::chrono::duration<float, std::milli> const budget(ctx.progressive_budget);
+
+    do
+    {
+        layout.Step(1, 0);
+    } while (!layout.converged && std::chrono::steady_clock::now() - start < budget);
+    layout.Write(cache.graph, submission);
+    cache.drawdirty = true;
+    if (layout.converged)
+        cache.progressive.reset();
+}
+
+static void ImGuiGraphNodeUpdateAndDrawGraph(ImGuiGraphNodeContext & ctx, ImGuiGraphNodeContextCache & cache, ImGuiGraphNode_Submission const & submission)
 {
-    auto & cache = g_ctx.graph_caches[g_ctx.lastid];
     float const ppu = cache.pixel_per_unit;
     ImVec2 const cursor_pos = ImGui::GetCursorScreenPos();
     ImDrawList * const drawlist = ImGui::GetWindowDrawList();
 
+    cache.cursor = cursor_pos;
+
+    if (cache.job && cache.job->done)
+    {
+        if (!cache.job->cancelled)
+        {
+            cache.graph = std::move(cache.job->graph);
+            cache.drawdirty = true;
+            cache.textsizes_dirty = true;
+        }
+        cache.job.reset();
+    }
+#ifdef IMGUI_GRAPHNODE_DEBUG_GRAPHID
+    // Same hash computed from different keys means a collision
+    IM_ASSERT(cache.graphid_current != cache.graphid_previous || cache.graphkey_current == cache.graphkey_previous);
+#endif /* IMGUI_GRAPHNODE_DEBUG_GRAPHID */
     if (cache.graphid_current != cache.graphid_previous)
     {
-        ImGuiGraphNodeRenderGraphLayout(cache);
+        ImGuiGraphNode_LayoutSeed seed;
+        bool const seeded = ImGuiGraphNode_FillLayoutSeed(seed, cache.graph, submission.layout, cache.flags);
+
+        cache.progressive.reset();
+        cache.textsizes_dirty = true;
+        if ((cache.flags & ImGuiGraphNodeFlags_ProgressiveLayout) && submission.layout == ImGuiGraphNodeLayout_ForceDirected)
+        {
+            if (cache.job)
+            {
+                cache.job->cancelled = true;
+                cache.job.reset();
+            }
+            cache.progressive.reset(new ImGuiGraphNode_ForceLayout());
+            cache.progressive->Init(submission, seeded ? &seed : nullptr);
+        }
+        else if (cache.flags & ImGuiGraphNodeFlags_AsyncLayout)
+        {
+            ImGuiGraphNodeQueueLayoutJob(ctx, cache, submission, seeded ? &seed : nullptr);
+        }
+        else
+        {
+            if (cache.job)
+            {
+                cache.job->cancelled = true;
+                cache.job.reset();
+            }
+            ImGuiGraphNodeComputeGraphLayout(ctx, cache.graph, submission, ctx.gvcontext, seeded ? &seed : nullptr);
+            cache.drawdirty = true;
+        }
         cache.graphid_previous = cache.graphid_current;
-        cache.cursor_previous.x = cursor_pos.x - 1; // force recompute draw buffers
+#ifdef IMGUI_GRAPHNODE_DEBUG_GRAPHID
+        cache.graphkey_previous.swap(cache.graphkey_current);
+#endif /* IMGUI_GRAPHNODE_DEBUG_GRAPHID */
     }
-    cache.graphid_current.clear();
-    agclose(g_ctx.gvgraph);
-    g_ctx.gvgraph = nullptr;
-
-    cache.cursor_current = cursor_pos;
-    if (cache.cursor_current.x != cache.cursor_previous.x || cache.cursor_current.y != cache.cursor_previous.y)
+    cache.graphid_current = 0;
+#ifdef IMGUI_GRAPHNODE_DEBUG_GRAPHID
+    cache.graphkey_current.clear();
+#endif /* IMGUI_GRAPHNODE_DEBUG_GRAPHID */
+    if (cache.progressive)
+        ImGuiGraphNodeStepProgressiveLayout(ctx, cache, submission);
+
+    if (cache.textsizes_font != ImGui::GetFont() || cache.textsizes_font_size != ImGui::GetFontSize())
+        cache.textsizes_dirty = true;
+    if (cache.textsizes_dirty || cache.textsizes.size() != (size_t)(cache.graph.GetNodeCount() + cache.graph.GetEdgeCount()))
+    {
+        ImGuiGraphNodeMeasureLabels(cache);
+        cache.drawdirty = true;
+    }
+    if (cache.drawdirty || cache.drawppu != ppu)
     {
-        cache.drawnodes.resize(ImGuiGraphNodeFillDrawNodeBuffer(cache.graph, nullptr, cursor_pos, ppu));
-        ImGuiGraphNodeFillDrawNodeBuffer(cache.graph, cache.drawnodes.data(), cursor_pos, ppu);
-        cache.drawedges.resize(ImGuiGraphNodeFillDrawEdgeBuffer(cache.graph, nullptr, cursor_pos, ppu));
-        ImGuiGraphNodeFillDrawEdgeBuffer(cache.graph, cache.drawedges.data(), cursor_pos, ppu);
-        cache.cursor_previous = cache.cursor_current;
+        ImVec2 const * const textsizes = cache.textsizes.data();
+
+        cache.drawpoints.clear();
+        cache.hitgrid.Clear();
+        cache.drawnodes.resize(ImGuiGraphNodeFillDrawNodeBuffer(cache.graph, textsizes, nullptr, cache.drawpoints, cache.hitgrid, ppu));
+        ImGuiGraphNodeFillDrawNodeBuffer(cache.graph, textsizes, cache.drawnodes.data(), cache.drawpoints, cache.hitgrid, ppu);
+        cache.drawedges.resize(ImGuiGraphNodeFillDrawEdgeBuffer(cache.graph, textsizes + cache.drawnodes.size(), nullptr, cache.drawpoints, cache.hitgrid, ppu, ctx.draw_threads));
+        ImGuiGraphNodeFillDrawEdgeBuffer(cache.graph, textsizes + cache.drawnodes.size(), cache.drawedges.data(), cache.drawpoints, cache.hitgrid, ppu, ctx.draw_threads);
+        cache.hitgrid.Build();
+        ImGuiGraphNode_TrimVector(cache.drawnodes);
+        ImGuiGraphNode_TrimVector(cache.drawedges);
+        ImGuiGraphNode_TrimVector(cache.drawpoints);
+        ImGuiGraphNode_TrimVector(cache.hitgrid.items);
+        ImGuiGraphNode_TrimVector(cache.hitgrid.cells);
+        ImGuiGraphNode_TrimVector(cache.hitgrid.cellitems);
+        cache.drawdirty = false;
+        cache.drawppu = ppu;
     }
 
+    ImVec2 const * const drawpoints = cache.drawpoints.data();
+    ImRect clip(drawlist->GetClipRectMin(), drawlist->GetClipRectMax());
+    int const vtx_start = drawlist->VtxBuffer.Size;
+
+    clip.Translate(ImVec2(-cursor_pos.x, -cursor_pos.y));
     for (auto const & node : cache.drawnodes)
     {
-        drawlist->AddConvexPolyFilled(node.path, IMGUI_GRAPHNODE_DRAW_NODE_PATH_COUNT, node.fillcolor);
-        drawlist->AddPolyline(node.path, IMGUI_GRAPHNODE_DRAW_NODE_PATH_COUNT, node.color, ImDrawFlags_Closed, 1.f);
-        drawlist->AddText(node.textpos, node.color, node.text);
+        if (!clip.Overlaps(node.bb))
+            continue;
+        drawlist->AddConvexPolyFilled(drawpoints + node.path_offset, node.path_count, node.fillcolor);
+        drawlist->AddPolyline(drawpoints + node.path_offset, node.path_count, node.color, ImDrawFlags_Closed, 1.f);
     }
     for (auto const & edge : cache.drawedges)
     {
-        drawlist->AddText(edge.textpos, edge.color, edge.text);
-        drawlist->AddPolyline(edge.path, IMGUI_GRAPHNODE_DRAW_EDGE_PATH_COUNT, edge.color, ImDrawFlags_None, 1.f);
+        if (!clip.Overlaps(edge.bb))
+            continue;
+        drawlist->AddPolyline(drawpoints + edge.path_offset, edge.path_count, edge.color, ImDrawFlags_None, 1.f);
         drawlist->AddTriangleFilled(edge.arrow1, edge.arrow2, edge.arrow3, edge.color);
     }
+    // Geometry was emitted in graph space, move it to the graph's screen
+    // position in a single pass over the new vertices.
+    ImDrawVert * const vtx_end = drawlist->VtxBuffer.Data + drawlist->VtxBuffer.Size;
+    for (ImDrawVert * vtx = drawlist->VtxBuffer.Data + vtx_start; vtx < vtx_end; ++vtx)
+    {
+        vtx->pos.x += cursor_pos.x;
+        vtx->pos.y += cursor_pos.y;
+    }
+    // Text is emitted afterwards at its screen position, as glyphs are
+    // clipped on the CPU against the clip rectangle.
+    for (auto const & node : cache.drawnodes)
+    {
+        if (!clip.Overlaps(node.bb))
+            continue;
+        drawlist->AddText(ImVec2(node.textpos.x + cursor_pos.x, node.textpos.y + cursor_pos.y), node.color, node.text);
+    }
+    for (auto const & edge : cache.drawedges)
+    {
+        if (!clip.Overlaps(edge.bb))
+            continue;
+        drawlist->AddText(ImVec2(edge.textpos.x + cursor_pos.x, edge.textpos.y + cursor_pos.y), edge.color, edge.text);
+    }
     ImGui::Dummy(ImVec2(cache.graph.size.x * ppu, cache.graph.size.y * ppu));
 }
+
+bool IMGUI_GRAPHNODE_NAMESPACE::EndNodeGraph()
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+    auto & cache = ctx.graph_caches[ctx.lastid];
+
+    ImGuiGraphNodeUpdateAndDrawGraph(ctx, cache, cache.submission);
+    cache.memory_usage = ImGuiGraphNode_GetCacheMemoryUsage(cache);
+    return cache.job == nullptr && cache.progressive == nullptr;
+}
+
+bool IMGUI_GRAPHNODE_NAMESPACE::IsNodeGraphLayoutPending()
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+    auto const it = ctx.graph_caches.find(ctx.lastid);
+    return it != ctx.graph_caches.end() && (it->second.job != nullptr || it->second.progressive != nullptr);
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::SetNodeGraphLayoutBudget(float milliseconds)
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+
+    ctx.progressive_budget = milliseconds;
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::SetNodeGraphDrawThreads(int num_threads)
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+
+    ctx.draw_threads = num_threads;
+}
+
+size_t IMGUI_GRAPHNODE_NAMESPACE::GetNodeGraphMemoryUsage()
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+    size_t bytes = 0;
+
+    for (auto const & it : ctx.graph_caches)
+        bytes += ImGuiGraphNode_GetCacheMemoryUsage(it.second);
+    return bytes;
+}
+
+size_t IMGUI_GRAPHNODE_NAMESPACE::GetNodeGraphMemoryUsage(char const * id)
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+    auto const it = ctx.graph_caches.find(ImGui::GetID(id));
+    return it != ctx.graph_caches.end() ? ImGuiGraphNode_GetCacheMemoryUsage(it->second) : 0;
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::SetNodeGraphCacheLimits(int max_unused_frames, size_t max_bytes)
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+
+    ctx.cache_max_unused_frames = max_unused_frames;
+    ctx.cache_max_bytes = max_bytes;
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::SetNodeGraphDiskCache(char const * directory)
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+    std::lock_guard<std::mutex> lock(ctx.diskcache_mutex);
+
+    ctx.diskcache_directory = directory ? directory : "";
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::GetNodeGraphDiskCacheStats(int * hits, int * misses)
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+
+    if (hits)
+        *hits = ctx.diskcache_hits;
+    if (misses)
+        *misses = ctx.diskcache_misses;
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::GetNodeGraphAllocationStats(ImGuiGraphNodeAllocationStats * stats)
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+
+    stats->allocations = GImGuiGraphNodeAllocations.allocations.load(std::memory_order_relaxed);
+    stats->frees = GImGuiGraphNodeAllocations.frees.load(std::memory_order_relaxed);
+    stats->bytes = GImGuiGraphNodeAllocations.bytes.load(std::memory_order_relaxed);
+    stats->frame_allocations = ctx.frame_allocations;
+    stats->frame_arena_size = ctx.frame_arena.capacity;
+    stats->frame_arena_used = ctx.frame_arena.last_used;
+}
+
+ImGuiGraphNodeGraph * IMGUI_GRAPHNODE_NAMESPACE::CreateGraph()
+{
+    static std::atomic<ImU64> counter { 0 };
+    ImGuiGraphNodeGraph * const graph = IM_NEW(ImGuiGraphNodeGraph)();
+
+    graph->uid = ++counter;
+    return graph;
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::DestroyGraph(ImGuiGraphNodeGraph * graph)
+{
+    IM_DELETE(graph);
+}
+
+static ImGuiID ImGuiGraphNodeGraphEdgeLabelID(char const * id)
+{
+    return ImHashStr(id, ImGui::FindRenderedTextEnd(id) - id);
+}
+
+// Labels of removed elements are left in the string buffer until they make
+// up half of it, at which point the buffer is rebuilt from live elements.
+static void ImGuiGraphNodeGraphCompactStrings(ImGuiGraphNodeGraph * graph)
+{
+    ImGuiGraphNode_Submission & submission = graph->submission;
+
+    if (graph->garbage * 2 < submission.strings.size())
+        return;
+
+    ImGuiGraphNode_Vector<char> strings;
+
+    strings.swap(submission.strings);
+    for (auto & node : submission.nodes)
+    {
+        char const * const label = strings.data() + node.label;
+        node.label = submission.AddString(label, label + strlen(label));
+    }
+    for (auto & edge : submission.edges)
+    {
+        char const * const label = strings.data() + edge.label;
+        edge.label = submission.AddString(label, label + strlen(label));
+    }
+    graph->garbage = 0;
+}
+
+static void ImGuiGraphNodeGraphRemoveEdgeAt(ImGuiGraphNodeGraph * graph, int index)
+{
+    ImGuiGraphNode_Submission & submission = graph->submission;
+    ImGuiGraphNode_SubmittedEdge const & edge = submission.edges[index];
+    ImGuiGraphNode_SubmittedEdge const & last = submission.edges.back();
+
+    graph->garbage += strlen(submission.GetString(edge.label)) + 1;
+    graph->edgeIndices.erase(std::make_tuple(edge.name, edge.tail, edge.head));
+    if (index != (int)submission.edges.size() - 1)
+    {
+        graph->edgeIndices[std::make_tuple(last.name, last.tail, last.head)] = index;
+        submission.edges[index] = last;
+    }
+    submission.edges.pop_back();
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::GraphAddNode(ImGuiGraphNodeGraph * graph, char const * id)
+{
+    ImVec4 const color = ImGui::GetStyle().Colors[ImGuiCol_Text];
+    ImVec4 const fillcolor = ImVec4(0.f, 0.f, 0.f, 0.f);
+    GraphAddNode(graph, id, color, fillcolor);
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::GraphAddNode(ImGuiGraphNodeGraph * graph, char const * id, ImVec4 const & color, ImVec4 const & fillcolor)
+{
+    ImGuiID const imid = ImHashStr(id);
+
+    if (graph->nodeIndices.find(imid) != graph->nodeIndices.end())
+    {
+        GraphUpdateNode(graph, id, color, fillcolor);
+        return;
+    }
+
+    ImGuiGraphNode_SubmittedNode node;
+
+    node.id = imid;
+    node.label = graph->submission.AddString(id, ImGui::FindRenderedTextEnd(id));
+    node.color = ImGui::ColorConvertFloat4ToU32(color);
+    node.fillcolor = ImGui::ColorConvertFloat4ToU32(fillcolor);
+    graph->nodeIndices[imid] = (int)graph->submission.nodes.size();
+    graph->submission.nodes.push_back(node);
+    graph->generation++;
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::GraphUpdateNode(ImGuiGraphNodeGraph * graph, char const * id, ImVec4 const & color, ImVec4 const & fillcolor)
+{
+    auto const it = graph->nodeIndices.find(ImHashStr(id));
+    IM_ASSERT(it != graph->nodeIndices.end());
+    ImGuiGraphNode_SubmittedNode & node = graph->submission.nodes[it->second];
+    ImU32 const color_u32 = ImGui::ColorConvertFloat4ToU32(color);
+    ImU32 const fillcolor_u32 = ImGui::ColorConvertFloat4ToU32(fillcolor);
+
+    if (node.color != color_u32 || node.fillcolor != fillcolor_u32)
+    {
+        node.color = color_u32;
+        node.fillcolor = fillcolor_u32;
+        graph->generation++;
+    }
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::GraphRemoveNode(ImGuiGraphNodeGraph * graph, char const * id)
+{
+    ImGuiGraphNode_Submission & submission = graph->submission;
+    ImGuiID const imid = ImHashStr(id);
+    auto const it = graph->nodeIndices.find(imid);
+
+    if (it == graph->nodeIndices.end())
+        return;
+
+    int const index = it->second;
+
+    for (int i = (int)submission.edges.size() - 1; i >= 0; --i)
+    {
+        if (submission.edges[i].tail == imid || submission.edges[i].head == imid)
+        {
+            ImGuiGraphNodeGraphRemoveEdgeAt(graph, i);
+        }
+    }
+    graph->garbage += strlen(submission.GetString(submission.nodes[index].label)) + 1;
+    graph->nodeIndices.erase(it);
+    if (index != (int)submission.nodes.size() - 1)
+    {
+        graph->nodeIndices[submission.nodes.back().id] = index;
+        submission.nodes[index] = submission.nodes.back();
+    }
+    submission.nodes.pop_back();
+    ImGuiGraphNodeGraphCompactStrings(graph);
+    graph->generation++;
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::GraphAddEdge(ImGuiGraphNodeGraph * graph, char const * id, char const * node_id_a, char const * node_id_b)
+{
+    ImVec4 const color = ImGui::GetStyle().Colors[ImGuiCol_Text];
+    GraphAddEdge(graph, id, node_id_a, node_id_b, color);
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::GraphAddEdge(ImGuiGraphNodeGraph * graph, char const * id, char const * node_id_a, char const * node_id_b, ImVec4 const & color)
+{
+    ImGuiGraphNode_SubmittedEdge edge;
+
+    edge.name = ImHashStr(id);
+    edge.tail = ImHashStr(node_id_a);
+    edge.head = ImHashStr(node_id_b);
+    IM_ASSERT(graph->nodeIndices.find(edge.tail) != graph->nodeIndices.end());
+    IM_ASSERT(graph->nodeIndices.find(edge.head) != graph->nodeIndices.end());
+    if (graph->edgeIndices.find(std::make_tuple(edge.name, edge.tail, edge.head)) != graph->edgeIndices.end())
+    {
+        GraphUpdateEdge(graph, id, node_id_a, node_id_b, color);
+        return;
+    }
+    edge.id = ImGuiGraphNodeGraphEdgeLabelID(id);
+    edge.label = graph->submission.AddString(id, ImGui::FindRenderedTextEnd(id));
+    edge.color = ImGui::ColorConvertFloat4ToU32(color);
+    graph->edgeIndices[std::make_tuple(edge.name, edge.tail, edge.head)] = (int)graph->submission.edges.size();
+    graph->submission.edges.push_back(edge);
+    graph->generation++;
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::GraphUpdateEdge(ImGuiGraphNodeGraph * graph, char const * id, char const * node_id_a, char const * node_id_b, ImVec4 const & color)
+{
+    auto const it = graph->edgeIndices.find(std::make_tuple(ImHashStr(id), ImHashStr(node_id_a), ImHashStr(node_id_b)));
+    IM_ASSERT(it != graph->edgeIndices.end());
+    ImGuiGraphNode_SubmittedEdge & edge = graph->submission.edges[it->second];
+    ImU32 const color_u32 = ImGui::ColorConvertFloat4ToU32(color);
+
+    if (edge.color != color_u32)
+    {
+        edge.color = color_u32;
+        graph->generation++;
+    }
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::GraphRemoveEdge(ImGuiGraphNodeGraph * graph, char const * id, char const * node_id_a, char const * node_id_b)
+{
+    auto const it = graph->edgeIndices.find(std::make_tuple(ImHashStr(id), ImHashStr(node_id_a), ImHashStr(node_id_b)));
+
+    if (it == graph->edgeIndices.end())
+        return;
+    ImGuiGraphNodeGraphRemoveEdgeAt(graph, it->second);
+    ImGuiGraphNodeGraphCompactStrings(graph);
+    graph->generation++;
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::GraphClear(ImGuiGraphNodeGraph * graph)
+{
+    graph->submission.Clear();
+    graph->nodeIndices.clear();
+    graph->edgeIndices.clear();
+    graph->garbage = 0;
+    graph->generation++;
+}
+
+bool IMGUI_GRAPHNODE_NAMESPACE::GraphIsDirty(ImGuiGraphNodeGraph const * graph)
+{
+    return graph->generation != graph->layout_generation;
+}
+
+// The graph content is fully identified by its uid and generation, there is
+// no need to go through its nodes and edges. The address isn't enough, a new
+// graph can be allocated where a destroyed one was.
+static void ImGuiGraphNodeHashRetainedGraph(ImGuiGraphNodeContextCache & cache, ImGuiGraphNodeGraph * graph, ImGuiGraphNodeLayout layout)
+{
+    ImGuiGraphNode_HashGraphId(cache, &layout, sizeof(layout));
+    ImGuiGraphNode_HashGraphId(cache, &graph->uid, sizeof(graph->uid));
+    ImGuiGraphNode_HashGraphId(cache, &graph->generation, sizeof(graph->generation));
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::DrawNodeGraph(char const * id, ImGuiGraphNodeGraph * graph, ImGuiGraphNodeLayout layout, float pixel_per_unit, ImGuiGraphNodeFlags flags)
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+
+    ctx.lastid = ImGui::GetID(id);
+    auto & cache = ImGuiGraphNodeGetCache(ctx, ctx.lastid);
+    IM_ASSERT(cache.graphid_current == 0);
+    cache.flags = flags;
+    cache.pixel_per_unit = pixel_per_unit;
+    graph->submission.layout = layout;
+
+    ImGuiGraphNodeHashRetainedGraph(cache, graph, layout);
+    graph->layout_generation = graph->generation;
+
+    ImGuiGraphNodeUpdateAndDrawGraph(ctx, cache, graph->submission);
+    cache.memory_usage = ImGuiGraphNode_GetCacheMemoryUsage(cache);
+}
+
+void IMGUI_GRAPHNODE_NAMESPACE::LayoutNodeGraphs(ImGuiGraphNodeBatchItem const * items, int count, int num_threads)
+{
+    ImGuiGraphNodeContext & ctx = *GImGuiGraphNode;
+    ImGuiGraphNode_Vector<ImGuiGraphNode_Graph> graphs(count);
+    ImGuiGraphNode_Vector<ImGuiGraphNode_Submission> submissions(count);
+
+    // Submissions are copied so that a graph can appear with several layouts
+    for (int i = 0; i < count; ++i)
+    {
+        submissions[i] = items[i].graph->submission;
+        submissions[i].layout = items[i].layout;
+    }
+    ImGuiGraphNodeRenderGraphLayouts(ctx, graphs.data(), submissions.data(), count, num_threads);
+
+    // Caches are keyed and hashed exactly like DrawNodeGraph() does, so that
+    // the first draw finds the layout up to date
+    for (int i = 0; i < count; ++i)
+    {
+        ImGuiGraphNodeBatchItem const & item = items[i];
+        auto & cache = ImGuiGraphNodeGetCache(ctx, ImGui::GetID(item.id));
+
+        IM_ASSERT(cache.graphid_current == 0);
+        if (cache.job)
+        {
+            cache.job->cancelled = true;
+            cache.job.reset();
+        }
+        cache.progressive.reset();
+        item.graph->submission.layout = item.layout;
+        ImGuiGraphNodeHashRetainedGraph(cache, item.graph, item.layout);
+        item.graph->layout_generation = item.graph->generation;
+        cache.graph = std::move(graphs[i]);
+        cache.drawdirty = true;
+        cache.textsizes_dirty = true;
+        cache.graphid_previous = cache.graphid_current;
+        cache.graphid_current = 0;
+#ifdef IMGUI_GRAPHNODE_DEBUG_GRAPHID
+        cache.graphkey_previous.swap(cache.graphkey_current);
+        cache.graphkey_current.clear();
+#endif /* IMGUI_GRAPHNODE_DEBUG_GRAPHID */
+        cache.memory_usage = ImGuiGraphNode_GetCacheMemoryUsage(cache);
+    }
+}
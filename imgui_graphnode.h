@@ -19,19 +19,95 @@ enum ImGuiGraphNodeLayout_
     ImGuiGraphNodeLayout_Neato,
     ImGuiGraphNodeLayout_Osage,
     ImGuiGraphNodeLayout_Sfdp,
-    ImGuiGraphNodeLayout_Twopi
+    ImGuiGraphNodeLayout_Twopi,
+    ImGuiGraphNodeLayout_ForceDirected, // Built-in multithreaded engine for large graphs, edges are straight lines
+    ImGuiGraphNodeLayout_Tree, // Built-in linear time layout for trees and forests, other graphs fall back to Dot
+    ImGuiGraphNodeLayout_Layered, // Built-in layered layout for directed graphs, much faster than Dot on large graphs, edges are polylines
+    ImGuiGraphNodeLayout_COUNT
+};
+
+typedef int ImGuiGraphNodeFlags;
+
+enum ImGuiGraphNodeFlags_
+{
+    ImGuiGraphNodeFlags_None = 0,
+    ImGuiGraphNodeFlags_AsyncLayout = 1 << 0, // Compute the layout on a worker thread, the previous layout stays displayed until the new one is ready
+    ImGuiGraphNodeFlags_IncrementalLayout = 1 << 1, // Neato, Fdp, Sfdp and ForceDirected only: start from the positions of the previous layout instead of from scratch
+    ImGuiGraphNodeFlags_PinPreviousNodes = 1 << 2, // With ImGuiGraphNodeFlags_IncrementalLayout, nodes of the previous layout don't move (Neato, Fdp and ForceDirected, Sfdp ignores it)
+    ImGuiGraphNodeFlags_ProgressiveLayout = 1 << 3 // ForceDirected only: the layout is advanced within a time budget every frame and displayed while it settles
+};
+
+struct ImGuiGraphNodeContext;
+struct ImGuiGraphNodeGraph;
+
+// Retained graph laid out by LayoutNodeGraphs(), then drawn with DrawNodeGraph() using the same id and layout
+struct ImGuiGraphNodeBatchItem
+{
+    char const * id;
+    ImGuiGraphNodeGraph * graph;
+    ImGuiGraphNodeLayout layout;
+};
+
+// Heap usage of the library containers, see GetNodeGraphAllocationStats()
+struct ImGuiGraphNodeAllocationStats
+{
+    size_t allocations; // since startup, all contexts and threads
+    size_t frees;
+    size_t bytes; // currently allocated
+    size_t frame_allocations; // during the last complete frame, 0 once graphs are steady
+    size_t frame_arena_size; // bytes held for the submissions of a frame
+    size_t frame_arena_used; // bytes used by the submissions of the last complete frame
 };
 
 namespace IMGUI_GRAPHNODE_NAMESPACE
 {
-    IMGUI_API void CreateContext();
-    IMGUI_API void DestroyContext();
-    IMGUI_API bool BeginNodeGraph(char const * id, ImGuiGraphNodeLayout layout = ImGuiGraphNodeLayout_Dot, float pixel_per_unit = 100.f);
+    // Each context owns its graph caches, graphviz context and layout worker.
+    // The first context created becomes the current one.
+    IMGUI_API ImGuiGraphNodeContext * CreateContext();
+    IMGUI_API void DestroyContext(ImGuiGraphNodeContext * ctx = NULL); // NULL = destroy current context
+    IMGUI_API ImGuiGraphNodeContext * GetCurrentContext();
+    IMGUI_API void SetCurrentContext(ImGuiGraphNodeContext * ctx);
+    IMGUI_API bool BeginNodeGraph(char const * id, ImGuiGraphNodeLayout layout = ImGuiGraphNodeLayout_Dot, float pixel_per_unit = 100.f, ImGuiGraphNodeFlags flags = ImGuiGraphNodeFlags_None);
     IMGUI_API void NodeGraphAddNode(char const * id);
     IMGUI_API void NodeGraphAddNode(char const * id, ImVec4 const & color, ImVec4 const & fillcolor);
     IMGUI_API void NodeGraphAddEdge(char const * id, char const * node_id_a, char const * node_id_b);
     IMGUI_API void NodeGraphAddEdge(char const * id, char const * node_id_a, char const * node_id_b, ImVec4 const & color);
-    IMGUI_API void EndNodeGraph();
+    // Bulk submission, equivalent to one call per element but hashing and copying in one pass. Only the hovered
+    // element is added as an ImGui item: the index of the hovered element is returned, -1 if none, and when there is
+    // one it is the last item. When several elements share the hovered id, the last of them wins like later ImGui items do.
+    // NULL colors use the same defaults as the single element functions.
+    IMGUI_API int NodeGraphAddNodes(char const * const * ids, int count, ImU32 const * colors = NULL, ImU32 const * fillcolors = NULL);
+    IMGUI_API int NodeGraphAddEdges(char const * const * ids, char const * const * node_ids_a, char const * const * node_ids_b, int count, ImU32 const * colors = NULL);
+    // Unlabeled edges from node_ids[i] to node_ids[targets[j]] for offsets[i] <= j < offsets[i + 1], offsets has count + 1
+    // entries. Node ids are hashed once rather than once per edge. Edges are identified by their tail and head, so repeated
+    // edges between the same nodes are laid out once. The hovered index is the one in targets.
+    IMGUI_API int NodeGraphAddEdges(char const * const * node_ids, int count, int const * offsets, int const * targets, ImU32 const * colors = NULL);
+    IMGUI_API bool EndNodeGraph(); // false while the layout is pending or still settling
+    IMGUI_API bool IsNodeGraphLayoutPending(); // true while an async layout is computed or a progressive layout settles
+    IMGUI_API void SetNodeGraphLayoutBudget(float milliseconds); // time spent per frame on each progressive layout, at least one iteration
+    IMGUI_API void SetNodeGraphDrawThreads(int num_threads); // threads filling the draw buffers of graphs with many edges, 0 for one per core, 1 (default) for the calling thread only
+    IMGUI_API size_t GetNodeGraphMemoryUsage(); // bytes held by all graphs' caches
+    IMGUI_API size_t GetNodeGraphMemoryUsage(char const * id); // bytes held by one graph's cache, 0 if it has none
+    IMGUI_API void SetNodeGraphCacheLimits(int max_unused_frames, size_t max_bytes); // 0 disables a limit
+    IMGUI_API void SetNodeGraphDiskCache(char const * directory); // existing directory where layouts are stored and reused between runs, NULL disables
+    IMGUI_API void GetNodeGraphDiskCacheStats(int * hits, int * misses);
+    IMGUI_API void GetNodeGraphAllocationStats(ImGuiGraphNodeAllocationStats * stats);
+
+    // Retained mode: the graph is kept across frames and only laid out again when modified
+    IMGUI_API ImGuiGraphNodeGraph * CreateGraph();
+    IMGUI_API void DestroyGraph(ImGuiGraphNodeGraph * graph);
+    IMGUI_API void GraphAddNode(ImGuiGraphNodeGraph * graph, char const * id);
+    IMGUI_API void GraphAddNode(ImGuiGraphNodeGraph * graph, char const * id, ImVec4 const & color, ImVec4 const & fillcolor);
+    IMGUI_API void GraphUpdateNode(ImGuiGraphNodeGraph * graph, char const * id, ImVec4 const & color, ImVec4 const & fillcolor);
+    IMGUI_API void GraphRemoveNode(ImGuiGraphNodeGraph * graph, char const * id);
+    IMGUI_API void GraphAddEdge(ImGuiGraphNodeGraph * graph, char const * id, char const * node_id_a, char const * node_id_b);
+    IMGUI_API void GraphAddEdge(ImGuiGraphNodeGraph * graph, char const * id, char const * node_id_a, char const * node_id_b, ImVec4 const & color);
+    IMGUI_API void GraphUpdateEdge(ImGuiGraphNodeGraph * graph, char const * id, char const * node_id_a, char const * node_id_b, ImVec4 const & color);
+    IMGUI_API void GraphRemoveEdge(ImGuiGraphNodeGraph * graph, char const * id, char const * node_id_a, char const * node_id_b);
+    IMGUI_API void GraphClear(ImGuiGraphNodeGraph * graph);
+    IMGUI_API bool GraphIsDirty(ImGuiGraphNodeGraph const * graph);
+    IMGUI_API void DrawNodeGraph(char const * id, ImGuiGraphNodeGraph * graph, ImGuiGraphNodeLayout layout = ImGuiGraphNodeLayout_Dot, float pixel_per_unit = 100.f, ImGuiGraphNodeFlags flags = ImGuiGraphNodeFlags_None);
+    IMGUI_API void LayoutNodeGraphs(ImGuiGraphNodeBatchItem const * items, int count, int num_threads = 0); // blocking, ids are resolved in the current window, 0 threads = one per core
 }
 
 #endif /* !IMGUI_GRAPHNODE_H_ */
@@ -2,6 +2,8 @@
 #include "imgui_graphnode_internal.h"
 #include "imgui_graphnode_demo.h"
 
+#include <chrono>
+
 template <class T>
 struct RBNode
 {
@@ -302,7 +304,7 @@ void draw_rbnode(RBNode<std::string> * node, RBNode<std::string> * found_node)
     }
 }
 
-void draw_rbtree(ImGuiGraphNodeLayout layout, float ppu)
+void draw_rbtree(ImGuiGraphNodeLayout layout, float ppu, ImGuiGraphNodeFlags graphflags)
 {
     static RBTree<std::string> tree;
     static char bufadd[64] = { 0 };
@@ -354,19 +356,22 @@ void draw_rbtree(ImGuiGraphNodeLayout layout, float ppu)
         ImGui::SameLine();
         ImGui::TextColored(ImVec4(1.f, 0.f, 0.f, 1.f), "node '%s' not found", bufsearch);
     }
-    if (ImGuiGraphNode::BeginNodeGraph("example3", layout, ppu))
+    if (ImGuiGraphNode::BeginNodeGraph("example3", layout, ppu, graphflags))
     {
         if (tree.root)
         {
             draw_rbnode(tree.root, found_node);
         }
-        ImGuiGraphNode::EndNodeGraph();
+        if (!ImGuiGraphNode::EndNodeGraph())
+        {
+            ImGui::TextDisabled("layout in progress...");
+        }
     }
 }
 
-void draw_example1(ImGuiGraphNodeLayout layout, float ppu)
+void draw_example1(ImGuiGraphNodeLayout layout, float ppu, ImGuiGraphNodeFlags graphflags)
 {
-    if (ImGuiGraphNode::BeginNodeGraph("example1", layout, ppu))
+    if (ImGuiGraphNode::BeginNodeGraph("example1", layout, ppu, graphflags))
     {
         ImGuiGraphNode::NodeGraphAddNode("A");
         ImGuiGraphNode::NodeGraphAddNode("B");
@@ -380,9 +385,9 @@ void draw_example1(ImGuiGraphNodeLayout layout, float ppu)
     }
 }
 
-void draw_example2(ImGuiGraphNodeLayout layout, float ppu)
+void draw_example2(ImGuiGraphNodeLayout layout, float ppu, ImGuiGraphNodeFlags graphflags)
 {
-    if (ImGuiGraphNode::BeginNodeGraph("example2", layout, ppu))
+    if (ImGuiGraphNode::BeginNodeGraph("example2", layout, ppu, graphflags))
     {
         ImGuiGraphNode::NodeGraphAddNode("LR_0");
         ImGuiGraphNode::NodeGraphAddNode("LR_1");
@@ -411,7 +416,7 @@ void draw_example2(ImGuiGraphNodeLayout layout, float ppu)
     }
 }
 
-void draw_clickable(ImGuiGraphNodeLayout layout, float ppu)
+void draw_clickable(ImGuiGraphNodeLayout layout, float ppu, ImGuiGraphNodeFlags graphflags)
 {
     static bool nodeClickedA = false;
     static bool nodeHoveredA = false;
@@ -420,7 +425,7 @@ void draw_clickable(ImGuiGraphNodeLayout layout, float ppu)
     static bool edgeClicked = false;
     static bool edgeHovered = false;
 
-    if (ImGuiGraphNode::BeginNodeGraph("clickable", layout, ppu))
+    if (ImGuiGraphNode::BeginNodeGraph("clickable", layout, ppu, graphflags))
     {
         // First node
         ImVec4 color = ImVec4(1.f, 1.f, 1.f, 1.f);
@@ -459,12 +464,208 @@ void draw_clickable(ImGuiGraphNodeLayout layout, float ppu)
     }
 }
 
+// Random splines of 1 to 3 cubic segments, plus a few polylines
+void benchmark_build_graph(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Vector<ImVec2> & textsizes, int edge_count)
+{
+    unsigned int seed = 1;
+    auto const random = [&seed](float range)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / (float)(1 << 24) * range;
+    };
+
+    graph.Clear();
+    graph.Reserve(0, edge_count, 16);
+    graph.size = ImVec2(100.f, 100.f);
+
+    int const labels[2] = { graph.AddString(""), graph.AddString("label") };
+
+    for (int i = 0; i < edge_count; ++i)
+    {
+        int const point_count = (i % 4) == 3 ? 3 : (i % 4) * 3 + 4;
+
+        graph.AddEdge((ImGuiID)i + 1, 0, 0, labels[(i % 8) == 0], IM_COL32_WHITE);
+
+        ImVec2 * const points = graph.AddEdgePoints(point_count);
+        ImVec2 p(random(100.f), random(100.f));
+
+        for (int j = 0; j < point_count; ++j)
+        {
+            points[j] = p;
+            p.x += random(2.f) - 1.f;
+            p.y += random(2.f) - 1.f;
+        }
+        graph.edge_label_pos.back() = p;
+    }
+    textsizes.resize(edge_count);
+    for (int i = 0; i < edge_count; ++i)
+    {
+        textsizes[i] = ImGui::CalcTextSize(graph.GetString(graph.edge_labels[i]));
+    }
+}
+
+// Samples the cubic Bezier segment p[0..3] uniformly, one sample at a time
+// with Horner's method
+void benchmark_tessellate_cubic(ImVec2 const * p, ImVec2 * out, int out_count)
+{
+    ImVec2 const a(-p[0].x + 3.f * p[1].x - 3.f * p[2].x + p[3].x, -p[0].y + 3.f * p[1].y - 3.f * p[2].y + p[3].y);
+    ImVec2 const b(3.f * p[0].x - 6.f * p[1].x + 3.f * p[2].x, 3.f * p[0].y - 6.f * p[1].y + 3.f * p[2].y);
+    ImVec2 const c(3.f * (p[1].x - p[0].x), 3.f * (p[1].y - p[0].y));
+
+    for (int i = 0; i < out_count; ++i)
+    {
+        float const t = (float)i / (float)(out_count - 1);
+
+        out[i].x = ((a.x * t + b.x) * t + c.x) * t + p[0].x;
+        out[i].y = ((a.y * t + b.y) * t + c.y) * t + p[0].y;
+    }
+}
+
+// Edge curves, hit quads and arrows computed one sample at a time, the way
+// ImGuiGraphNodeFillDrawEdgeBuffer did before it was batched
+void benchmark_fill_edges_scalar(ImGuiGraphNode_Graph const & graph, ImVec2 const * textsizes, ImGuiGraphNode_DrawEdge * drawedges, ImGuiGraphNode_Vector<ImVec2> & drawpoints, ImGuiGraphNode_Vector<ImGuiGraphNode_HitItem> & hititems, float ppu, float tol)
+{
+    for (int i = 0; i < graph.GetEdgeCount(); ++i)
+    {
+        ImVec2 const * const points = graph.GetEdgePoints(i);
+        int const point_count = graph.GetEdgePointCount(i);
+        ImVec2 const textsize = textsizes[i];
+
+        for (int j = 0; j < point_count - 1; ++j)
+        {
+            ImVec2 const p1(points[j].x * ppu, (graph.size.y - points[j].y) * ppu);
+            ImVec2 const p2(points[j + 1].x * ppu, (graph.size.y - points[j + 1].y) * ppu);
+            ImVec2 const dir(p2.x - p1.x, p2.y - p1.y);
+            float const magLeft = ImSqrt(dir.x * dir.x + dir.y * dir.y);
+            float const magRight = ImSqrt(dir.y * dir.y + dir.x * dir.x);
+            ImVec2 const left(-dir.y / magLeft * 3.f, dir.x / magLeft * 3.f);
+            ImVec2 const right(dir.y / magRight * 3.f, -dir.x / magRight * 3.f);
+            ImVec2 const a(p1.x + left.x, p1.y + left.y);
+            ImVec2 const b(p1.x + right.x, p1.y + right.y);
+            ImVec2 const c(p2.x + right.x, p2.y + right.y);
+            ImVec2 const d(p2.x + left.x, p2.y + left.y);
+            ImRect rectbb(a, a);
+
+            rectbb.Add(b);
+            rectbb.Add(c);
+            rectbb.Add(d);
+            hititems.push_back({ { a, b, c, d }, rectbb, graph.edge_ids[i], false });
+        }
+
+        int const path_offset = (int)drawpoints.size();
+
+        if (point_count >= 4 && (point_count - 1) % 3 == 0)
+        {
+            drawpoints.push_back(points[0]);
+            for (int j = 0; j + 3 < point_count; j += 3)
+            {
+                int const n = ImGuiGraphNode_CountSplineSamples(points + j, 4, ppu, tol) - 1;
+                size_t const first = drawpoints.size();
+
+                drawpoints.resize(first + n);
+                benchmark_tessellate_cubic(points + j, &drawpoints[first - 1], n + 1);
+            }
+        }
+        else
+        {
+            drawpoints.insert(drawpoints.end(), points, points + point_count);
+        }
+
+        int const path_count = (int)drawpoints.size() - path_offset;
+        ImVec2 * const path = drawpoints.data() + path_offset;
+        ImRect bb(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+        for (int x = 0; x < path_count; ++x)
+        {
+            path[x].x *= ppu;
+            path[x].y = (graph.size.y - path[x].y) * ppu;
+            bb.Add(path[x]);
+        }
+
+        ImVec2 const lastpoint = path[path_count - 1];
+        float dirx = lastpoint.x - path[path_count - 2].x;
+        float diry = lastpoint.y - path[path_count - 2].y;
+        float const mag = ImSqrt(dirx * dirx + diry * diry);
+
+        dirx /= mag;
+        diry /= mag;
+        drawedges[i].path_offset = path_offset;
+        drawedges[i].path_count = path_count;
+        drawedges[i].textpos = ImVec2(graph.edge_label_pos[i].x * ppu - textsize.x / 2.f, (graph.size.y - graph.edge_label_pos[i].y) * ppu - textsize.y / 2.f);
+        drawedges[i].arrow1 = ImVec2(lastpoint.x - dirx * ppu * 0.1f - diry * ppu * 0.0437f, lastpoint.y - diry * ppu * 0.1f + dirx * ppu * 0.0437f);
+        drawedges[i].arrow2 = ImVec2(lastpoint.x - dirx * ppu * 0.1f + diry * ppu * 0.0437f, lastpoint.y - diry * ppu * 0.1f - dirx * ppu * 0.0437f);
+        drawedges[i].arrow3 = lastpoint;
+        bb.Add(drawedges[i].arrow1);
+        bb.Add(drawedges[i].arrow2);
+        bb.Expand(1.f);
+        drawedges[i].bb = bb;
+    }
+}
+
+// Best time over a few runs of the edge buffer refill of a large graph: the
+// scalar reference, then the batched kernels on one thread and on all cores
+void draw_benchmark()
+{
+    static int edge_count = 100000;
+    static float ppu = 100.f;
+    static double results[3] = { 0.0, 0.0, 0.0 };
+    int const num_threads = ImMax((int)std::thread::hardware_concurrency(), 1);
+
+    ImGui::SliderInt("edges", &edge_count, 1000, 500000);
+    if (ImGui::Button("run"))
+    {
+        ImGuiGraphNode_Graph graph;
+        ImGuiGraphNode_Vector<ImVec2> textsizes;
+        ImGuiGraphNode_Vector<ImGuiGraphNode_DrawEdge> drawedges(edge_count);
+        ImGuiGraphNode_Vector<ImVec2> scalarpoints;
+        ImGuiGraphNode_Vector<ImGuiGraphNode_HitItem> scalarhits;
+        ImGuiGraphNode_NoInitVector<ImVec2> drawpoints;
+        ImGuiGraphNode_HitGrid hitgrid;
+        float const tol = ImGui::GetStyle().CurveTessellationTol;
+
+        benchmark_build_graph(graph, textsizes, edge_count);
+        for (int test = 0; test < 3; ++test)
+        {
+            results[test] = DBL_MAX;
+            for (int run = 0; run < 5; ++run)
+            {
+                auto const start = std::chrono::steady_clock::now();
+
+                if (test == 0)
+                {
+                    scalarpoints.clear();
+                    scalarhits.clear();
+                    benchmark_fill_edges_scalar(graph, textsizes.data(), drawedges.data(), scalarpoints, scalarhits, ppu, tol);
+                }
+                else
+                {
+                    drawpoints.clear();
+                    hitgrid.Clear();
+                    ImGuiGraphNodeFillDrawEdgeBuffer(graph, textsizes.data(), drawedges.data(), drawpoints, hitgrid, ppu, test == 1 ? 1 : num_threads);
+                }
+                results[test] = ImMin(results[test], std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            }
+        }
+    }
+    if (results[0] > 0.0)
+    {
+        ImGui::Text("scalar reference: %.2f ms", results[0]);
+        ImGui::Text("batched, 1 thread: %.2f ms (x%.1f)", results[1], results[0] / results[1]);
+        ImGui::Text("batched, %d threads: %.2f ms (x%.1f)", num_threads, results[2], results[0] / results[2]);
+    }
+}
+
 void IMGUI_GRAPHNODE_NAMESPACE::ShowGraphNodeDemoWindow(bool * p_open)
 {
     static ImGuiGraphNodeLayout layout = ImGuiGraphNodeLayout_Circo;
     static bool autoresize = true;
     static float ppu = 100.f;
+    static bool asynclayout = false;
+    static bool incrementallayout = false;
+    static bool pinnodes = false;
+    static bool progressivelayout = false;
     int flags = 0;
+    ImGuiGraphNodeFlags graphflags = ImGuiGraphNodeFlags_None;
 
     if (autoresize)
     {
@@ -478,8 +679,29 @@ void IMGUI_GRAPHNODE_NAMESPACE::ShowGraphNodeDemoWindow(bool * p_open)
             return true;
         };
         ImGui::Checkbox("auto resize window", &autoresize);
-        ImGui::Combo("layout", (int *)&layout, items_getter, nullptr, 7);
+        ImGui::Combo("layout", (int *)&layout, items_getter, nullptr, ImGuiGraphNodeLayout_COUNT);
         ImGui::SliderFloat("pixel per unit", &ppu, 30.f, 200.f);
+        ImGui::Checkbox("async layout", &asynclayout);
+        if (asynclayout)
+        {
+            graphflags |= ImGuiGraphNodeFlags_AsyncLayout;
+        }
+        ImGui::Checkbox("incremental layout", &incrementallayout);
+        if (incrementallayout)
+        {
+            graphflags |= ImGuiGraphNodeFlags_IncrementalLayout;
+            ImGui::SameLine();
+            ImGui::Checkbox("pin previous nodes", &pinnodes);
+            if (pinnodes)
+            {
+                graphflags |= ImGuiGraphNodeFlags_PinPreviousNodes;
+            }
+        }
+        ImGui::Checkbox("progressive layout", &progressivelayout);
+        if (progressivelayout)
+        {
+            graphflags |= ImGuiGraphNodeFlags_ProgressiveLayout;
+        }
         if (ImGui::BeginTabBar("tabbar", ImGuiTabBarFlags_None))
         {
             bool drawExample1 = ImGui::BeginTabItem("Example 1");
@@ -489,7 +711,7 @@ void IMGUI_GRAPHNODE_NAMESPACE::ShowGraphNodeDemoWindow(bool * p_open)
             }
             if (drawExample1)
             {
-                draw_example1(layout, ppu);
+                draw_example1(layout, ppu, graphflags);
                 ImGui::EndTabItem();
             }
 
@@ -500,18 +722,18 @@ void IMGUI_GRAPHNODE_NAMESPACE::ShowGraphNodeDemoWindow(bool * p_open)
             }
             if (drawExample2)
             {
-                draw_example2(layout, ppu);
+                draw_example2(layout, ppu, graphflags);
                 ImGui::EndTabItem();
             }
 
             bool drawRBTree = ImGui::BeginTabItem("Red-black tree");
             if (ImGui::IsItemClicked())
             {
-                layout = ImGuiGraphNodeLayout_Dot;
+                layout = ImGuiGraphNodeLayout_Tree;
             }
             if (drawRBTree)
             {
-                draw_rbtree(layout, ppu);
+                draw_rbtree(layout, ppu, graphflags);
                 ImGui::EndTabItem();
             }
 
@@ -522,7 +744,13 @@ void IMGUI_GRAPHNODE_NAMESPACE::ShowGraphNodeDemoWindow(bool * p_open)
             }
             if (drawClickable)
             {
-                draw_clickable(layout, ppu);
+                draw_clickable(layout, ppu, graphflags);
+                ImGui::EndTabItem();
+            }
+
+            if (ImGui::BeginTabItem("Benchmark"))
+            {
+                draw_benchmark();
                 ImGui::EndTabItem();
             }
 
@@ -2,7 +2,102 @@
 #include "imgui_graphnode_internal.h"
 #include "imgui_internal.h"
 
-ImGuiGraphNodeContext g_ctx;
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* !_WIN32 */
+
+#ifndef GImGuiGraphNode
+ImGuiGraphNodeContext * GImGuiGraphNode = nullptr;
+#endif /* GImGuiGraphNode */
+
+ImGuiGraphNode_AllocationCounters GImGuiGraphNodeAllocations;
+
+void * ImGuiGraphNode_HeapAlloc(size_t size)
+{
+    GImGuiGraphNodeAllocations.allocations.fetch_add(1, std::memory_order_relaxed);
+    GImGuiGraphNodeAllocations.bytes.fetch_add(size, std::memory_order_relaxed);
+    return ::operator new(size);
+}
+
+void ImGuiGraphNode_HeapFree(void * ptr, size_t size)
+{
+    if (ptr == nullptr)
+        return;
+    GImGuiGraphNodeAllocations.frees.fetch_add(1, std::memory_order_relaxed);
+    GImGuiGraphNodeAllocations.bytes.fetch_sub(size, std::memory_order_relaxed);
+    ::operator delete(ptr);
+}
+
+void ImGuiGraphNode_ArenaDeleter::operator()(ImGuiGraphNode_Arena * arena) const
+{
+    arena->~ImGuiGraphNode_Arena();
+    ImGuiGraphNode_HeapFree(arena, sizeof(ImGuiGraphNode_Arena));
+}
+
+ImGuiGraphNode_ArenaPtr ImGuiGraphNode_NewArena()
+{
+    return ImGuiGraphNode_ArenaPtr(::new (ImGuiGraphNode_HeapAlloc(sizeof(ImGuiGraphNode_Arena))) ImGuiGraphNode_Arena());
+}
+
+void * ImGuiGraphNode_Arena::Alloc(size_t size, size_t align)
+{
+    uintptr_t start = 0;
+
+    if (block)
+    {
+        uintptr_t const base = (uintptr_t)(block + 1);
+
+        start = (base + offset + align - 1) & ~(uintptr_t)(align - 1);
+        if (start + size > base + block->size)
+            start = 0;
+    }
+    if (start == 0)
+    {
+        // Blocks at least double so that a growing arena takes few of them
+        size_t const size_with_align = size + align;
+        size_t const block_size = ImMax(ImMax(size_with_align, next_block_size), ImMax(capacity, (size_t)IMGUI_GRAPHNODE_ARENA_BLOCK_SIZE));
+        ImGuiGraphNode_ArenaBlock * const next = static_cast<ImGuiGraphNode_ArenaBlock *>(ImGuiGraphNode_HeapAlloc(sizeof(ImGuiGraphNode_ArenaBlock) + block_size));
+
+        next->prev = block;
+        next->size = block_size;
+        block = next;
+        capacity += block_size;
+        next_block_size = 0;
+        start = ((uintptr_t)(block + 1) + align - 1) & ~(uintptr_t)(align - 1);
+    }
+    offset = start + size - (uintptr_t)(block + 1);
+    used += size;
+    return reinterpret_cast<void *>(start);
+}
+
+void ImGuiGraphNode_Arena::Reset()
+{
+    last_used = used;
+    if (block && (block->prev || (block->size > IMGUI_GRAPHNODE_ARENA_BLOCK_SIZE && block->size > used * 4)))
+    {
+        Release();
+        next_block_size = last_used;
+    }
+    offset = 0;
+    used = 0;
+}
+
+void ImGuiGraphNode_Arena::Release()
+{
+    while (block)
+    {
+        ImGuiGraphNode_ArenaBlock * const prev = block->prev;
+
+        ImGuiGraphNode_HeapFree(block, sizeof(ImGuiGraphNode_ArenaBlock) + block->size);
+        block = prev;
+    }
+    offset = 0;
+    used = 0;
+    capacity = 0;
+}
 
 ImGuiGraphNode_ShortString<32> ImGuiIDToString(char const * id)
 {
@@ -12,15 +107,50 @@ ImGuiGraphNode_ShortString<32> ImGuiIDToString(char const * id)
     return str;
 }
 
+ImGuiGraphNode_ShortString<32> ImGuiIDToString(ImGuiID id)
+{
+    ImGuiGraphNode_ShortString<32> str;
+
+    sprintf(str.buf, "%u", id);
+    return str;
+}
+
 ImGuiGraphNode_ShortString<16> ImVec4ColorToString(ImVec4 const & color)
+{
+    return ImU32ColorToString(ImGui::ColorConvertFloat4ToU32(color));
+}
+
+ImGuiGraphNode_ShortString<16> ImU32ColorToString(ImU32 color)
 {
     ImGuiGraphNode_ShortString<16> str;
-    ImU32 const rgba = ImGui::ColorConvertFloat4ToU32(color);
 
-    sprintf(str.buf, "#%x", rgba);
+    sprintf(str.buf, "#%x", color);
     return str;
 }
 
+// 64-bit FNV-1a, chaining calls through the seed hashes the concatenation of
+// all the buffers.
+ImU64 ImGuiGraphNode_HashData(void const * data, size_t size, ImU64 seed)
+{
+    unsigned char const * bytes = static_cast<unsigned char const *>(data);
+    ImU64 hash = seed ? seed : 14695981039346656037ULL;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void ImGuiGraphNode_HashGraphId(ImGuiGraphNodeContextCache & cache, void const * data, size_t size)
+{
+    cache.graphid_current = ImGuiGraphNode_HashData(data, size, cache.graphid_current);
+#ifdef IMGUI_GRAPHNODE_DEBUG_GRAPHID
+    cache.graphkey_current.append(static_cast<char const *>(data), size);
+#endif /* IMGUI_GRAPHNODE_DEBUG_GRAPHID */
+}
+
 ImU32 ImGuiGraphNode_StringToU32Color(char const * color)
 {
     ImU32 rgba;
@@ -51,93 +181,462 @@ char * ImGuiGraphNode_ReadLine(char ** stringp)
     return strsep(stringp, "\n");
 }
 
-bool ImGuiGraphNode_ReadGraphFromMemory(ImGuiGraphNodeContextCache & cache, char const * data, size_t size)
+void ImGuiGraphNode_Submission::Clear()
+{
+    nodes.clear();
+    edges.clear();
+    strings.clear();
+}
+
+// The previous storage is dropped without being freed, which is what arenas
+// expect. Sizes are reserved again as the graph likely didn't change.
+void ImGuiGraphNode_Submission::Reset(ImGuiGraphNode_Arena * arena)
+{
+    size_t const node_count = nodes.size();
+    size_t const edge_count = edges.size();
+    size_t const string_size = strings.size();
+
+    ImGuiGraphNode_ResetVector(nodes, arena);
+    ImGuiGraphNode_ResetVector(edges, arena);
+    ImGuiGraphNode_ResetVector(strings, arena);
+    nodes.reserve(node_count);
+    edges.reserve(edge_count);
+    strings.reserve(string_size);
+}
+
+void ImGuiGraphNode_StringPool::Reset(ImGuiGraphNode_Arena * arena)
+{
+    ImGuiGraphNode_ResetVector(buffer, arena);
+    ImGuiGraphNode_ResetVector(slots, arena);
+    count = 0;
+}
+
+// Kept at most half full so that probe sequences stay short
+static void ImGuiGraphNode_GrowStringPool(ImGuiGraphNode_StringPool & pool, int string_count)
+{
+    size_t size = ImMax(pool.slots.size(), (size_t)64);
+
+    while ((size_t)string_count * 2 > size)
+        size *= 2;
+    if (size == pool.slots.size())
+        return;
+
+    ImGuiGraphNode_Vector<int> old(size, -1, pool.slots.get_allocator());
+
+    old.swap(pool.slots);
+    for (int offset : old)
+    {
+        if (offset < 0)
+            continue;
+
+        size_t slot = ImHashData(pool.buffer.data() + offset, strlen(pool.buffer.data() + offset)) & (size - 1);
+
+        while (pool.slots[slot] >= 0)
+            slot = (slot + 1) & (size - 1);
+        pool.slots[slot] = offset;
+    }
+}
+
+void ImGuiGraphNode_StringPool::Reserve(int string_count, size_t size)
+{
+    ImGuiGraphNode_GrowStringPool(*this, string_count);
+    buffer.reserve(size);
+}
+
+int ImGuiGraphNode_StringPool::Add(char const * begin, char const * end)
+{
+    size_t const length = end - begin;
+
+    if ((count + 1) * 2 > (int)slots.size())
+        ImGuiGraphNode_GrowStringPool(*this, ImMax(count + 1, (int)slots.size()));
+
+    size_t slot = ImHashData(begin, length) & (slots.size() - 1);
+
+    for (; slots[slot] >= 0; slot = (slot + 1) & (slots.size() - 1))
+    {
+        char const * const str = buffer.data() + slots[slot];
+
+        if (strncmp(str, begin, length) == 0 && str[length] == '\0')
+            return slots[slot];
+    }
+
+    int const offset = (int)buffer.size();
+
+    buffer.insert(buffer.end(), begin, end);
+    buffer.push_back('\0');
+    slots[slot] = offset;
+    ++count;
+    return offset;
+}
+
+void ImGuiGraphNode_Graph::Clear()
+{
+    size = ImVec2();
+    scale = 0.f;
+    if (arena == nullptr)
+        return;
+
+    ImGuiGraphNode_Arena * const a = arena.get();
+
+    ImGuiGraphNode_ResetVector(node_ids, a);
+    ImGuiGraphNode_ResetVector(node_labels, a);
+    ImGuiGraphNode_ResetVector(node_pos, a);
+    ImGuiGraphNode_ResetVector(node_sizes, a);
+    ImGuiGraphNode_ResetVector(node_colors, a);
+    ImGuiGraphNode_ResetVector(node_fillcolors, a);
+    ImGuiGraphNode_ResetVector(edge_ids, a);
+    ImGuiGraphNode_ResetVector(edge_tails, a);
+    ImGuiGraphNode_ResetVector(edge_heads, a);
+    ImGuiGraphNode_ResetVector(edge_labels, a);
+    ImGuiGraphNode_ResetVector(edge_label_pos, a);
+    ImGuiGraphNode_ResetVector(edge_colors, a);
+    ImGuiGraphNode_ResetVector(edge_points, a);
+    ImGuiGraphNode_ResetVector(points, a);
+    strings.Reset(a);
+    arena->Reset();
+}
+
+void ImGuiGraphNode_Graph::CreateArena()
+{
+    if (arena != nullptr)
+        return;
+    IM_ASSERT(node_ids.empty() && edge_ids.empty() && strings.count == 0);
+    arena = ImGuiGraphNode_NewArena();
+
+    ImVec2 const keep_size = size;
+    float const keep_scale = scale;
+
+    Clear();
+    size = keep_size;
+    scale = keep_scale;
+}
+
+// Arrays grown one element at a time would leave their previous storage
+// behind in the arena, producers reserve them first. Edges are assumed to
+// be a single cubic segment.
+void ImGuiGraphNode_Graph::Reserve(size_t node_count, size_t edge_count, size_t string_size)
+{
+    CreateArena();
+    node_ids.reserve(node_count);
+    node_labels.reserve(node_count);
+    node_pos.reserve(node_count);
+    node_sizes.reserve(node_count);
+    node_colors.reserve(node_count);
+    node_fillcolors.reserve(node_count);
+    edge_ids.reserve(edge_count);
+    edge_tails.reserve(edge_count);
+    edge_heads.reserve(edge_count);
+    edge_labels.reserve(edge_count);
+    edge_label_pos.reserve(edge_count);
+    edge_colors.reserve(edge_count);
+    edge_points.reserve(edge_count + 1);
+    points.reserve(edge_count * 4);
+    strings.Reserve((int)(node_count + edge_count), string_size);
+}
+
+void ImGuiGraphNode_Graph::AddNode(ImGuiID id, int label, ImVec2 const & pos, ImVec2 const & size, ImU32 color, ImU32 fillcolor)
+{
+    CreateArena();
+    node_ids.push_back(id);
+    node_labels.push_back(label);
+    node_pos.push_back(pos);
+    node_sizes.push_back(size);
+    node_colors.push_back(color);
+    node_fillcolors.push_back(fillcolor);
+}
+
+void ImGuiGraphNode_Graph::AddEdge(ImGuiID id, ImGuiID tail, ImGuiID head, int label, ImU32 color)
+{
+    CreateArena();
+    if (edge_points.empty())
+        edge_points.push_back(0);
+    edge_ids.push_back(id);
+    edge_tails.push_back(tail);
+    edge_heads.push_back(head);
+    edge_labels.push_back(label);
+    edge_label_pos.push_back(ImVec2());
+    edge_colors.push_back(color);
+    edge_points.push_back((int)points.size());
+}
+
+ImVec2 * ImGuiGraphNode_Graph::AddEdgePoints(int count)
+{
+    size_t const offset = points.size();
+
+    points.resize(offset + count);
+    edge_points.back() += count;
+    return points.data() + offset;
+}
+
+void ImGuiGraphNode_Graph::PopEdge()
+{
+    edge_ids.pop_back();
+    edge_tails.pop_back();
+    edge_heads.pop_back();
+    edge_labels.pop_back();
+    edge_label_pos.pop_back();
+    edge_colors.pop_back();
+    edge_points.pop_back();
+    points.resize(edge_points.back());
+}
+
+int ImGuiGraphNode_Submission::AddString(char const * begin, char const * end)
+{
+    int const offset = (int)strings.size();
+
+    strings.insert(strings.end(), begin, end);
+    strings.push_back('\0');
+    return offset;
+}
+
+// Locale independent number parsing in the spirit of std::from_chars: the
+// whole token must be consumed for the conversion to succeed.
+bool ImGuiGraphNode_ParseInt(char const * str, int * out)
+{
+    bool const negative = *str == '-';
+    int value = 0;
+
+    if (*str == '-' || *str == '+')
+        ++str;
+    if (*str < '0' || *str > '9')
+        return false;
+    while (*str >= '0' && *str <= '9')
+        value = value * 10 + (*str++ - '0');
+    if (*str != '\0')
+        return false;
+    *out = negative ? -value : value;
+    return true;
+}
+
+bool ImGuiGraphNode_ParseFloat(char const * str, float * out)
+{
+    bool const negative = *str == '-';
+    double value = 0.0;
+    int digits = 0;
+
+    if (*str == '-' || *str == '+')
+        ++str;
+    for (; *str >= '0' && *str <= '9'; ++str, ++digits)
+        value = value * 10.0 + (*str - '0');
+    if (*str == '.')
+    {
+        double scale = 0.1;
+
+        for (++str; *str >= '0' && *str <= '9'; ++str, ++digits, scale *= 0.1)
+            value += (*str - '0') * scale;
+    }
+    if (digits == 0)
+        return false;
+    if (*str == 'e' || *str == 'E')
+    {
+        int exponent = 0;
+
+        if (!ImGuiGraphNode_ParseInt(str + 1, &exponent))
+            return false;
+        value *= pow(10.0, exponent);
+        str += strlen(str);
+    }
+    if (*str != '\0')
+        return false;
+    *out = (float)(negative ? -value : value);
+    return true;
+}
+
+static bool ImGuiGraphNode_ReadFloatToken(char ** stringp, float * out)
+{
+    char const * const token = ImGuiGraphNode_ReadToken(stringp);
+    return token != nullptr && ImGuiGraphNode_ParseFloat(token, out);
+}
+
+ImGuiGraphNode_PlainReader::ImGuiGraphNode_PlainReader(ImGuiGraphNode_Graph & out, ImGuiGraphNode_Submission const & submission) :
+    graph(out)
 {
-    char * copy = static_cast<char *>(alloca(sizeof(*copy) * size + 1));
-    char * line = nullptr;
+    graph.Reserve(submission.nodes.size(), submission.edges.size(), submission.strings.size());
+    edgeIdToInfo.reserve(submission.edges.size());
+    for (auto const & edge : submission.edges)
+    {
+        edgeIdToInfo.push_back(std::make_pair(edge.id, ImGuiGraphNode_EdgeInfo { edge.color }));
+    }
+    std::sort(edgeIdToInfo.begin(), edgeIdToInfo.end(), [](std::pair<ImGuiID, ImGuiGraphNode_EdgeInfo> const & a, std::pair<ImGuiID, ImGuiGraphNode_EdgeInfo> const & b)
+    {
+        return a.first < b.first;
+    });
+}
+
+bool ImGuiGraphNode_PlainReader::Feed(char const * data, size_t size)
+{
+    // Complete lines are parsed as soon as they are available, only the last
+    // incomplete line of a chunk is kept until the next one comes in.
+    while (size > 0 && !stopped && error == nullptr)
+    {
+        char const * const eol = static_cast<char const *>(memchr(data, '\n', size));
+        size_t const len = eol ? (size_t)(eol - data) : size;
+
+        line.insert(line.end(), data, data + len);
+        if (eol == nullptr)
+            break;
+        line.push_back('\0');
+        ParseLine(line.data());
+        line.clear();
+        data += len + 1;
+        size -= len + 1;
+    }
+    return error == nullptr;
+}
 
-    memcpy(copy, data, size);
-    copy[size] = '\0';
-    while ((line = ImGuiGraphNode_ReadLine(&copy)) != nullptr)
+bool ImGuiGraphNode_PlainReader::Finish()
+{
+    if (!line.empty() && !stopped && error == nullptr)
+    {
+        line.push_back('\0');
+        ParseLine(line.data());
+        line.clear();
+    }
+    if (!stopped && error == nullptr)
     {
-        char * token = ImGuiGraphNode_ReadToken(&line);
+        error = "unexpected end of input";
+    }
+    return error == nullptr;
+}
+
+void ImGuiGraphNode_PlainReader::ParseLine(char * str)
+{
+    char * token = ImGuiGraphNode_ReadToken(&str);
 
-        if (strcmp(token, "graph") == 0)
+    if (token == nullptr || *token == '\0')
+    {
+        return;
+    }
+    else if (strcmp(token, "graph") == 0)
+    {
+        if (!ImGuiGraphNode_ReadFloatToken(&str, &graph.scale)
+            || !ImGuiGraphNode_ReadFloatToken(&str, &graph.size.x)
+            || !ImGuiGraphNode_ReadFloatToken(&str, &graph.size.y))
         {
-            cache.graph.scale = atof(ImGuiGraphNode_ReadToken(&line));
-            cache.graph.size.x = atof(ImGuiGraphNode_ReadToken(&line));
-            cache.graph.size.y = atof(ImGuiGraphNode_ReadToken(&line));
+            error = "malformed graph statement";
         }
-        else if (strcmp(token, "node") == 0)
+    }
+    else if (strcmp(token, "node") == 0)
+    {
+        char const * const name = ImGuiGraphNode_ReadToken(&str);
+        char const * label = nullptr;
+        char const * color = nullptr;
+        char const * fillcolor = nullptr;
+        ImVec2 pos;
+        ImVec2 size;
+
+        if (name == nullptr
+            || !ImGuiGraphNode_ReadFloatToken(&str, &pos.x)
+            || !ImGuiGraphNode_ReadFloatToken(&str, &pos.y)
+            || !ImGuiGraphNode_ReadFloatToken(&str, &size.x)
+            || !ImGuiGraphNode_ReadFloatToken(&str, &size.y)
+            || (label = ImGuiGraphNode_ReadToken(&str)) == nullptr
+            || ImGuiGraphNode_ReadToken(&str) == nullptr // style
+            || ImGuiGraphNode_ReadToken(&str) == nullptr // shape
+            || (color = ImGuiGraphNode_ReadToken(&str)) == nullptr
+            || (fillcolor = ImGuiGraphNode_ReadToken(&str)) == nullptr)
         {
-            ImGuiGraphNode_Node node;
-
-            node.name = ImGuiGraphNode_ReadToken(&line);
-            node.pos.x = atof(ImGuiGraphNode_ReadToken(&line));
-            node.pos.y = atof(ImGuiGraphNode_ReadToken(&line));
-            node.size.x = atof(ImGuiGraphNode_ReadToken(&line));
-            node.size.y = atof(ImGuiGraphNode_ReadToken(&line));
-            node.label = ImGuiGraphNode_ReadToken(&line);
-            ImGuiGraphNode_ReadToken(&line); // style
-            ImGuiGraphNode_ReadToken(&line); // shape
-            node.color = ImGuiGraphNode_StringToU32Color(ImGuiGraphNode_ReadToken(&line));
-            node.fillcolor = ImGuiGraphNode_StringToU32Color(ImGuiGraphNode_ReadToken(&line));
-            cache.graph.nodes.push_back(node);
+            error = "malformed node statement";
+            return;
         }
-        else if (strcmp(token, "edge") == 0)
+        graph.AddNode(strtoul(name, nullptr, 10), graph.AddString(label), pos, size, ImGuiGraphNode_StringToU32Color(color), ImGuiGraphNode_StringToU32Color(fillcolor));
+    }
+    else if (strcmp(token, "edge") == 0)
+    {
+        char const * const tail = ImGuiGraphNode_ReadToken(&str);
+        char const * const head = ImGuiGraphNode_ReadToken(&str);
+        char const * const count = ImGuiGraphNode_ReadToken(&str);
+        int n = 0;
+
+        if (tail == nullptr || head == nullptr || count == nullptr || !ImGuiGraphNode_ParseInt(count, &n) || n < 2)
         {
-            ImGuiGraphNode_Edge edge;
+            error = "malformed edge statement";
+            return;
+        }
+        // Identifier, label and color are only known once the points are read
+        graph.AddEdge(0, strtoul(tail, nullptr, 10), strtoul(head, nullptr, 10), 0, 0);
+
+        ImVec2 * const points = graph.AddEdgePoints(n);
+        ImVec2 & labelPos = graph.edge_label_pos.back();
 
-            edge.tail = ImGuiGraphNode_ReadToken(&line);
-            edge.head = ImGuiGraphNode_ReadToken(&line);
-            int const n = atoi(ImGuiGraphNode_ReadToken(&line));
-            edge.points.resize(n);
-            for (int i = 0; i < n; ++i)
+        for (int i = 0; i < n; ++i)
+        {
+            if (!ImGuiGraphNode_ReadFloatToken(&str, &points[i].x) || !ImGuiGraphNode_ReadFloatToken(&str, &points[i].y))
             {
-                edge.points[i].x = atof(ImGuiGraphNode_ReadToken(&line));
-                edge.points[i].y = atof(ImGuiGraphNode_ReadToken(&line));
+                graph.PopEdge();
+                error = "malformed edge statement";
+                return;
             }
+        }
 
-            char const * s1 = ImGuiGraphNode_ReadToken(&line);
-            char const * s2 = ImGuiGraphNode_ReadToken(&line);
-            char const * s3 = ImGuiGraphNode_ReadToken(&line);
-            char const * s4 = ImGuiGraphNode_ReadToken(&line); (void)s4; // style
-            char const * s5 = ImGuiGraphNode_ReadToken(&line);
-            char const * identifier = nullptr;
+        char const * s1 = ImGuiGraphNode_ReadToken(&str);
+        char const * s2 = ImGuiGraphNode_ReadToken(&str);
+        char const * s3 = ImGuiGraphNode_ReadToken(&str);
+        char const * s4 = ImGuiGraphNode_ReadToken(&str); (void)s4; // style
+        char const * s5 = ImGuiGraphNode_ReadToken(&str);
+        char const * identifier = nullptr;
+        char const * label = "";
 
-            if (s3)
-            {
-                edge.label = s1;
-                edge.labelPos.x = atof(s2);
-                edge.labelPos.y = atof(s3);
-                identifier = s5 + 1;
-            }
-            else
+        if (s3)
+        {
+            identifier = s5;
+            if (identifier != nullptr
+                && (!ImGuiGraphNode_ParseFloat(s2, &labelPos.x) || !ImGuiGraphNode_ParseFloat(s3, &labelPos.y)))
             {
-                identifier = s2 + 1;
+                identifier = nullptr;
             }
-
-            // Edge ImGuiID is stored in the color property.
-            // It is used to access edge info, as graphviz doesn't serialize
-            // the edge's identifier. The actual color is then retrieve from
-            // the context cache.
-            edge.id = strtoul(identifier, nullptr, 16);
-            auto const it = cache.edgeIdToInfo.find(edge.id);
-            IM_ASSERT(it != cache.edgeIdToInfo.end());
-            edge.color = it->second.color;
-
-            cache.graph.edges.push_back(edge);
+            label = s1;
         }
-        else if (strcmp(token, "stop") == 0)
+        else
         {
-            return true;
+            identifier = s2;
         }
-        else
+        if (identifier == nullptr || *identifier != '#')
         {
-            IM_ASSERT(false);
+            graph.PopEdge();
+            error = "malformed edge statement";
+            return;
+        }
+
+        // Edge ImGuiID is stored in the color property.
+        // It is used to access edge info, as graphviz doesn't serialize
+        // the edge's identifier. The actual color is then retrieve from
+        // the submitted edges.
+        ImGuiID const id = strtoul(identifier + 1, nullptr, 16);
+        auto const it = std::lower_bound(edgeIdToInfo.begin(), edgeIdToInfo.end(), id, [](std::pair<ImGuiID, ImGuiGraphNode_EdgeInfo> const & a, ImGuiID id)
+        {
+            return a.first < id;
+        });
+        if (it == edgeIdToInfo.end() || it->first != id)
+        {
+            graph.PopEdge();
+            error = "unknown edge identifier";
+            return;
         }
+        graph.edge_ids.back() = id;
+        graph.edge_labels.back() = graph.AddString(label);
+        graph.edge_colors.back() = it->second.color;
+    }
+    else if (strcmp(token, "stop") == 0)
+    {
+        stopped = true;
+    }
+    else
+    {
+        error = "unknown statement";
     }
-    return true;
+}
+
+bool ImGuiGraphNode_ReadGraphFromMemory(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission, char const * data, size_t size, char const ** error)
+{
+    ImGuiGraphNode_PlainReader reader(graph, submission);
+    bool const ok = reader.Feed(data, size) && reader.Finish();
+
+    if (error)
+    {
+        *error = reader.error;
+    }
+    return ok;
 }
 
 char const * ImGuiGraphNode_GetEngineNameFromLayoutEnum(ImGuiGraphNodeLayout layout)
@@ -151,144 +650,1269 @@ char const * ImGuiGraphNode_GetEngineNameFromLayoutEnum(ImGuiGraphNodeLayout lay
         case ImGuiGraphNodeLayout_Osage: return "osage";
         case ImGuiGraphNodeLayout_Sfdp: return "sfdp";
         case ImGuiGraphNodeLayout_Twopi: return "twopi";
+        case ImGuiGraphNodeLayout_ForceDirected: return "forcedirected";
+        case ImGuiGraphNodeLayout_Tree: return "tree";
+        case ImGuiGraphNodeLayout_Layered: return "layered";
         default:
             IM_ASSERT(false);
             return "";
     }
 }
 
-float ImGuiGraphNode_BSplineVec2ComputeK(ImVec2 const * p, float const * t, int i, int k, float x)
+// Number of points needed for the cubic segment p[0..3] to stay within tol
+// pixels of the curve once scaled (Wang's formula), at least 1.
+static int ImGuiGraphNode_CalcCubicSampleCount(ImVec2 const * p, float scale, float tol)
 {
-    auto const f = [](float const * t, int i, int k, float x) -> float
-    {
-        if (t[i + k] == t[i])
-            return 0.f;
-        return (x - t[i]) / (t[i + k] - t[i]);
-    };
-    auto g = ImGuiGraphNode_BSplineVec2ComputeK;
-    if (k == 0)
-        return (x < t[i] || x >= t[i + 1]) ? 0.f : 1.f;
-    return f(t, i, k, x) * g(p, t, i, k - 1, x) + (1.f - f(t, i + 1, k, x)) * g(p, t, i + 1, k - 1, x);
+    float const ddx1 = p[0].x - 2.f * p[1].x + p[2].x;
+    float const ddy1 = p[0].y - 2.f * p[1].y + p[2].y;
+    float const ddx2 = p[1].x - 2.f * p[2].x + p[3].x;
+    float const ddy2 = p[1].y - 2.f * p[2].y + p[3].y;
+    float const dd = ImSqrt(ImMax(ddx1 * ddx1 + ddy1 * ddy1, ddx2 * ddx2 + ddy2 * ddy2)) * scale;
+
+    return ImClamp((int)ceilf(ImSqrt(0.75f * dd / tol)), 1, IMGUI_GRAPHNODE_DRAW_EDGE_PATH_COUNT);
 }
 
-ImVec2 ImGuiGraphNode_BSplineVec2(ImVec2 const * p, int m, int n, float x)
+// Number of points ImGuiGraphNode_TessellateSplineAdaptive writes for a
+// spline, so that the draw buffers of all edges can be allocated at once.
+// Short or flat cubic segments end up with a handful of points. Any other
+// control point count is drawn as a polyline through the points.
+int ImGuiGraphNode_CountSplineSamples(ImVec2 const * points, int count, float scale, float tol)
 {
-    if (n > (m - 2)) n = m - 2;
-    int const knotscount = m + n + 1;
-    float * const knots = (float *)alloca(knotscount * sizeof(*knots));
-    int i = 0;
+    IM_ASSERT(count >= 2);
+
+    if (count < 4 || (count - 1) % 3 != 0)
+        return count;
+
+    int total = 1;
+
+    for (int i = 0; i + 3 < count; i += 3)
+        total += ImGuiGraphNode_CalcCubicSampleCount(points + i, scale, tol);
+    return total;
+}
+
+// Writes the tessellation of a spline, transformed to offset + p * scale,
+// to out. scale is the pixels per unit, possibly negated to flip an axis.
+void ImGuiGraphNode_TessellateSplineAdaptive(ImVec2 const * points, int count, ImVec2 scale, ImVec2 offset, float tol, ImVec2 * out)
+{
+    IM_ASSERT(count >= 2);
 
-    for (; i <= n; ++i) knots[i] = 0.f;
-    for (; i < m; ++i) knots[i] = i / (float)(m + n);
-    for (; i < knotscount; ++i) knots[i] = 1.f;
+    if (count < 4 || (count - 1) % 3 != 0)
+    {
+        ImGuiGraphNode_TransformPoints(points, count, offset, scale, out);
+        return;
+    }
 
-    ImVec2 result(0.f, 0.f);
+    // Bezier curves are affine invariant, segments are evaluated from their
+    // transformed control points
+    float const pixel_scale = ImMax(ImFabs(scale.x), ImFabs(scale.y));
+    ImVec2 p[4];
 
-    for (i = 0; i < m; ++i)
+    ImGuiGraphNode_TransformPoints(points, 1, offset, scale, out++);
+    for (int i = 0; i + 3 < count; i += 3)
     {
-        float const k = ImGuiGraphNode_BSplineVec2ComputeK(p, knots, i, n, x);
+        int const n = ImGuiGraphNode_CalcCubicSampleCount(points + i, pixel_scale, tol);
 
-        result.x += p[i].x * k;
-        result.y += p[i].y * k;
+        ImGuiGraphNode_TransformPoints(points + i, 4, offset, scale, p);
+        ImGuiGraphNode_TessellateCubic(p, n, out);
+        out += n;
     }
-    return result;
 }
 
-ImVec2 ImGuiGraphNode_BSplineVec2(ImVec2 const * points, int count, float x)
+// Writes B(k / n) for k in [1, n] of the cubic Bezier p[0..3], B(0) being
+// the last point of the previous segment. Four samples are evaluated at once
+// with Horner's method in SIMD lanes, the last one is exactly p[3].
+void ImGuiGraphNode_TessellateCubic(ImVec2 const * p, int n, ImVec2 * out)
 {
-    return ImGuiGraphNode_BSplineVec2(points, count, 3, ImClamp(x, 0.f, 0.9999f));
-}
+    // Power basis coefficients of B(t) = a t^3 + b t^2 + c t + d
+    ImVec2 const a(-p[0].x + 3.f * p[1].x - 3.f * p[2].x + p[3].x, -p[0].y + 3.f * p[1].y - 3.f * p[2].y + p[3].y);
+    ImVec2 const b(3.f * p[0].x - 6.f * p[1].x + 3.f * p[2].x, 3.f * p[0].y - 6.f * p[1].y + 3.f * p[2].y);
+    ImVec2 const c(3.f * (p[1].x - p[0].x), 3.f * (p[1].y - p[0].y));
+    ImVec2 const d = p[0];
+    float const step = 1.f / (float)n;
+    int i = 0;
 
-#define IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_CELL_1(_line, _cell) \
-    ImGuiGraphNode_BinomialCoefficient(_line, _cell), \
+#if defined(IMGUI_ENABLE_SSE)
+    __m128 const ax = _mm_set1_ps(a.x), ay = _mm_set1_ps(a.y);
+    __m128 const bx = _mm_set1_ps(b.x), by = _mm_set1_ps(b.y);
+    __m128 const cx = _mm_set1_ps(c.x), cy = _mm_set1_ps(c.y);
+    __m128 const dx = _mm_set1_ps(d.x), dy = _mm_set1_ps(d.y);
+    __m128 const vstep = _mm_set1_ps(step);
+    __m128 const four = _mm_set1_ps(4.f);
+    __m128 k = _mm_setr_ps(1.f, 2.f, 3.f, 4.f);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 const t = _mm_mul_ps(k, vstep);
+        __m128 const x = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ax, t), bx), t), cx), t), dx);
+        __m128 const y = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ay, t), by), t), cy), t), dy);
+
+        _mm_storeu_ps(&out[i].x, _mm_unpacklo_ps(x, y));
+        _mm_storeu_ps(&out[i + 2].x, _mm_unpackhi_ps(x, y));
+        k = _mm_add_ps(k, four);
+    }
+#elif defined(IMGUI_GRAPHNODE_ENABLE_NEON)
+    float const first[4] = { 1.f, 2.f, 3.f, 4.f };
+    float32x4_t const ax = vdupq_n_f32(a.x), ay = vdupq_n_f32(a.y);
+    float32x4_t const bx = vdupq_n_f32(b.x), by = vdupq_n_f32(b.y);
+    float32x4_t const cx = vdupq_n_f32(c.x), cy = vdupq_n_f32(c.y);
+    float32x4_t const dx = vdupq_n_f32(d.x), dy = vdupq_n_f32(d.y);
+    float32x4_t const four = vdupq_n_f32(4.f);
+    float32x4_t k = vld1q_f32(first);
 
-#define IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_CELL_2(_line, _cell) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_CELL_1(_line, _cell) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_CELL_1(_line, _cell + 1)
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t const t = vmulq_n_f32(k, step);
+        float32x4x2_t xy;
 
-#define IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_CELL_4(_line, _cell) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_CELL_2(_line, _cell) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_CELL_2(_line, _cell + 2)
+        xy.val[0] = vmlaq_f32(dx, vmlaq_f32(cx, vmlaq_f32(bx, ax, t), t), t);
+        xy.val[1] = vmlaq_f32(dy, vmlaq_f32(cy, vmlaq_f32(by, ay, t), t), t);
+        vst2q_f32(&out[i].x, xy);
+        k = vaddq_f32(k, four);
+    }
+#endif /* IMGUI_ENABLE_SSE */
+    for (; i < n; ++i)
+    {
+        float const t = (float)(i + 1) * step;
 
-#define IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_CELL_8(_line, _cell) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_CELL_4(_line, _cell) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_CELL_4(_line, _cell + 4)
+        out[i].x = ((a.x * t + b.x) * t + c.x) * t + d.x;
+        out[i].y = ((a.y * t + b.y) * t + c.y) * t + d.y;
+    }
+    out[n - 1] = p[3];
+}
 
-#define IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_CELL_16(_line, _cell) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_CELL_8(_line, _cell) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_CELL_8(_line, _cell + 8)
+// Bounding box of points, two points per SIMD register
+ImRect ImGuiGraphNode_CalcBounds(ImVec2 const * points, int count)
+{
+    ImRect bb(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+    int i = 0;
 
-#define IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_LINE_1(_line) \
-    { IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_CELL_16(_line, 0) },
+#if defined(IMGUI_ENABLE_SSE)
+    if (count >= 2)
+    {
+        __m128 vmin = _mm_loadu_ps(&points[0].x);
+        __m128 vmax = vmin;
+        float m[4];
 
-#define IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_LINE_2(_line) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_LINE_1(_line) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_LINE_1(_line + 1)
+        for (i = 2; i + 2 <= count; i += 2)
+        {
+            __m128 const v = _mm_loadu_ps(&points[i].x);
 
-#define IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_LINE_4(_line) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_LINE_2(_line) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_LINE_2(_line + 2)
+            vmin = _mm_min_ps(vmin, v);
+            vmax = _mm_max_ps(vmax, v);
+        }
+        _mm_storeu_ps(m, vmin);
+        bb.Min = ImVec2(ImMin(m[0], m[2]), ImMin(m[1], m[3]));
+        _mm_storeu_ps(m, vmax);
+        bb.Max = ImVec2(ImMax(m[0], m[2]), ImMax(m[1], m[3]));
+    }
+#elif defined(IMGUI_GRAPHNODE_ENABLE_NEON)
+    if (count >= 2)
+    {
+        float32x4_t vmin = vld1q_f32(&points[0].x);
+        float32x4_t vmax = vmin;
+        float m[4];
 
-#define IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_LINE_8(_line) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_LINE_4(_line) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_LINE_4(_line + 4)
+        for (i = 2; i + 2 <= count; i += 2)
+        {
+            float32x4_t const v = vld1q_f32(&points[i].x);
 
-#define IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_LINE_16(_line) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_LINE_8(_line) \
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_LINE_8(_line + 8)
+            vmin = vminq_f32(vmin, v);
+            vmax = vmaxq_f32(vmax, v);
+        }
+        vst1q_f32(m, vmin);
+        bb.Min = ImVec2(ImMin(m[0], m[2]), ImMin(m[1], m[3]));
+        vst1q_f32(m, vmax);
+        bb.Max = ImVec2(ImMax(m[0], m[2]), ImMax(m[1], m[3]));
+    }
+#endif /* IMGUI_ENABLE_SSE */
+    for (; i < count; ++i)
+        bb.Add(points[i]);
+    return bb;
+}
 
-constexpr int ImGuiGraphNode_BinomialCoefficient(int n, int k)
+static ImGuiGraphNode_EllipseTable ImGuiGraphNode_BuildEllipseTable()
 {
-    return (n == 0 || k == 0 || n == k) ? 1 : ImGuiGraphNode_BinomialCoefficient(n - 1, k - 1) + ImGuiGraphNode_BinomialCoefficient(n - 1, k);
+    ImGuiGraphNode_EllipseTable table;
+
+    for (int count = IMGUI_GRAPHNODE_DRAW_NODE_PATH_MIN_COUNT; count <= IMGUI_GRAPHNODE_DRAW_NODE_PATH_COUNT; count *= 2)
+    {
+        ImVec2 * const points = table.points + count - IMGUI_GRAPHNODE_DRAW_NODE_PATH_MIN_COUNT;
+
+        for (int j = 0; j < count; ++j)
+        {
+            float const a = ((float)j / (float)count) * (IM_PI * 2.0f);
+
+            points[j] = ImVec2(ImCos(a), ImSin(a));
+        }
+    }
+    return table;
 }
 
-constexpr int ImGuiGraphNode_BinomialCoefficient_Table[16][16] =
+ImGuiGraphNode_EllipseTable const & ImGuiGraphNode_GetEllipseTable()
 {
-    IMGUIGRAPHNODE_BINOMIALCOEFFICIENT_TABLE_LINE_16(0)
-};
+    static ImGuiGraphNode_EllipseTable const table = ImGuiGraphNode_BuildEllipseTable();
 
-int ImGuiGraphNode_BinomialCoefficientTable(int n, int k)
+    return table;
+}
+
+// Largest radius drawn within max_error pixels of a circle at each level of
+// detail, like ImDrawList's circle auto tessellation. The last level is used
+// past that.
+void ImGuiGraphNode_CalcEllipseLodRadii(float max_error, float * radii)
 {
-    if (n >= 0 && n < 16 && k >= 0 && k < 16)
+    for (int lod = 0; lod < IMGUI_GRAPHNODE_DRAW_NODE_LOD_COUNT - 1; ++lod)
     {
-        return ImGuiGraphNode_BinomialCoefficient_Table[n][k];
+        int const count = IMGUI_GRAPHNODE_DRAW_NODE_PATH_MIN_COUNT << lod;
+
+        radii[lod] = max_error / (1.f - ImCos(IM_PI / count));
     }
-    else
+    radii[IMGUI_GRAPHNODE_DRAW_NODE_LOD_COUNT - 1] = FLT_MAX;
+}
+
+// out[i] = center + points[i] * scale, two points per SIMD register
+void ImGuiGraphNode_TransformPoints(ImVec2 const * points, int count, ImVec2 center, ImVec2 scale, ImVec2 * out)
+{
+    int i = 0;
+
+#if defined(IMGUI_ENABLE_SSE)
+    __m128 const vcenter = _mm_setr_ps(center.x, center.y, center.x, center.y);
+    __m128 const vscale = _mm_setr_ps(scale.x, scale.y, scale.x, scale.y);
+
+    for (; i + 2 <= count; i += 2)
+        _mm_storeu_ps(&out[i].x, _mm_add_ps(vcenter, _mm_mul_ps(_mm_loadu_ps(&points[i].x), vscale)));
+#elif defined(IMGUI_GRAPHNODE_ENABLE_NEON)
+    float const center4[4] = { center.x, center.y, center.x, center.y };
+    float const scale4[4] = { scale.x, scale.y, scale.x, scale.y };
+    float32x4_t const vcenter = vld1q_f32(center4);
+    float32x4_t const vscale = vld1q_f32(scale4);
+
+    for (; i + 2 <= count; i += 2)
+        vst1q_f32(&out[i].x, vmlaq_f32(vcenter, vld1q_f32(&points[i].x), vscale));
+#endif /* IMGUI_ENABLE_SSE */
+    for (; i < count; ++i)
     {
-        return ImGuiGraphNode_BinomialCoefficient(n, k);
+        out[i].x = center.x + points[i].x * scale.x;
+        out[i].y = center.y + points[i].y * scale.y;
     }
 }
 
-ImVec2 ImGuiGraphNode_BezierVec2(ImVec2 const * points, int count, float x)
+static float IsPointInRectangle_IsLeft(ImVec2 const & p0, ImVec2 const & p1, ImVec2 const & p2)
 {
-    ImVec2 result(0.f, 0.f);
+    return (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+}
 
-    for (int i = 0; i < count; ++i)
-    {
-        float const k = ImGuiGraphNode_BinomialCoefficientTable(count - 1, i) * ImPow(1 - x, count - i - 1) * ImPow(x, i);
+static bool IsPointInRectangle(ImVec2 const & a, ImVec2 const & b, ImVec2 const & c, ImVec2 const & d, ImVec2 const & p)
+{
+    return IsPointInRectangle_IsLeft(a, b, p) > 0
+        && IsPointInRectangle_IsLeft(b, c, p) > 0
+        && IsPointInRectangle_IsLeft(c, d, p) > 0
+        && IsPointInRectangle_IsLeft(d, a, p) > 0;
+}
 
-        result.x += points[i].x * k;
-        result.y += points[i].y * k;
-    }
-    return result;
+void ImGuiGraphNode_HitGrid::Clear()
+{
+    // Vectors are only cleared so their storage is reused by the next Build
+    items.clear();
+    cells.clear();
+    cellitems.clear();
+    width = 0;
+    height = 0;
 }
 
-void ImGuiGraphNodeRenderGraphLayout(ImGuiGraphNodeContextCache & cache)
+void ImGuiGraphNode_HitGrid::Build()
 {
-    char * data = nullptr;
-    size_t size = 0;
-    char const * const engine = ImGuiGraphNode_GetEngineNameFromLayoutEnum(cache.layout);
-    int ok = 0;
+    int const max_cells_per_axis = 256;
+    ImRect bounds(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
 
-    cache.graph = ImGuiGraphNode_Graph();
-    IM_ASSERT(g_ctx.gvcontext != nullptr);
-    IM_ASSERT(g_ctx.gvgraph != nullptr);
-    agattr(g_ctx.gvgraph, AGEDGE, (char *)"dir", "none");
-    ok = gvLayout(g_ctx.gvcontext, g_ctx.gvgraph, engine);
-    IM_ASSERT(ok == 0);
-    ok = gvRenderData(g_ctx.gvcontext, g_ctx.gvgraph, "plain", &data, &size);
-    IM_ASSERT(ok == 0);
-    ImGuiGraphNode_ReadGraphFromMemory(cache, data, size);
-    gvFreeRenderData(data);
-    gvFreeLayout(g_ctx.gvcontext, g_ctx.gvgraph);
+    cells.clear();
+    cellitems.clear();
+    width = 0;
+    height = 0;
+    if (items.empty())
+        return;
+    for (auto const & item : items)
+        bounds.Add(item.bb);
+
+    // Aim for about one item per cell
+    ImVec2 const size = bounds.GetSize();
+    float const area = ImMax(size.x * size.y, 1.f);
+
+    origin = bounds.Min;
+    cellsize = ImMax(ImSqrt(area / (float)items.size()), 8.f);
+    cellsize = ImMax(cellsize, ImMax(size.x, size.y) / (float)max_cells_per_axis);
+    width = ImMax((int)(size.x / cellsize) + 1, 1);
+    height = ImMax((int)(size.y / cellsize) + 1, 1);
+
+    // Counting sort of the items into the cells they overlap
+    cells.resize(width * height + 1, 0);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (int i = 0; i < (int)items.size(); ++i)
+        {
+            ImRect const & bb = items[i].bb;
+            int const x0 = ImClamp((int)((bb.Min.x - origin.x) / cellsize), 0, width - 1);
+            int const y0 = ImClamp((int)((bb.Min.y - origin.y) / cellsize), 0, height - 1);
+            int const x1 = ImClamp((int)((bb.Max.x - origin.x) / cellsize), 0, width - 1);
+            int const y1 = ImClamp((int)((bb.Max.y - origin.y) / cellsize), 0, height - 1);
+
+            for (int y = y0; y <= y1; ++y)
+            {
+                for (int x = x0; x <= x1; ++x)
+                {
+                    if (pass == 0)
+                        ++cells[y * width + x + 1];
+                    else
+                        cellitems[cells[y * width + x]++] = i;
+                }
+            }
+        }
+        if (pass == 0)
+        {
+            for (int c = 0; c < width * height; ++c)
+                cells[c + 1] += cells[c];
+            cellitems.resize(cells[width * height]);
+        }
+        else
+        {
+            // Filling advanced each start to the next cell's, shift them back
+            for (int c = width * height; c > 0; --c)
+                cells[c] = cells[c - 1];
+            cells[0] = 0;
+        }
+    }
+}
+
+// Nodes take precedence over the edges reaching them
+ImGuiGraphNode_HitItem const * ImGuiGraphNode_HitGrid::Query(ImVec2 const & p) const
+{
+    if (width == 0 || p.x < origin.x || p.y < origin.y)
+        return nullptr;
+
+    int const x = (int)((p.x - origin.x) / cellsize);
+    int const y = (int)((p.y - origin.y) / cellsize);
+
+    if (x >= width || y >= height)
+        return nullptr;
+
+    int const cell = y * width + x;
+    ImGuiGraphNode_HitItem const * edge = nullptr;
+
+    for (int i = cells[cell]; i < cells[cell + 1]; ++i)
+    {
+        ImGuiGraphNode_HitItem const & item = items[cellitems[i]];
+
+        if (!item.bb.Contains(p))
+            continue;
+        if (item.node)
+            return &item;
+        if (edge == nullptr && IsPointInRectangle(item.rect.a, item.rect.b, item.rect.c, item.rect.d, p))
+            edge = &item;
+    }
+    return edge;
+}
+
+// Worker threads shared by every ImGuiGraphNode_ParallelFor() call, one less
+// than the number of cores since callers run chunks too. Batches waiting for
+// a thread are chained through their link, so nothing is allocated per call.
+struct ImGuiGraphNode_ThreadPool
+{
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    ImGuiGraphNode_ParallelBatch * pending = nullptr;
+    std::vector<std::thread> threads;
+    bool quit = false;
+
+    ImGuiGraphNode_ThreadPool()
+    {
+        int const count = (int)std::thread::hardware_concurrency() - 1;
+
+        for (int t = 0; t < count; ++t)
+            threads.emplace_back([this]() { WorkerMain(); });
+    }
+
+    ~ImGuiGraphNode_ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        work_cv.notify_all();
+        for (auto & thread : threads)
+            thread.join();
+    }
+
+    // Takes the next chunk of batch, or of the first pending batch when batch
+    // is null. Must be called with the mutex held.
+    int Claim(ImGuiGraphNode_ParallelBatch *& batch)
+    {
+        if (batch == nullptr)
+            batch = pending;
+        if (batch == nullptr || batch->next == batch->chunk_count)
+            return -1;
+
+        int const chunk = batch->next++;
+
+        if (batch->next == batch->chunk_count)
+        {
+            ImGuiGraphNode_ParallelBatch ** it = &pending;
+
+            while (*it != batch)
+                it = &(*it)->link;
+            *it = batch->link;
+        }
+        return chunk;
+    }
+
+    // The batch must not be touched once its last chunk is counted as done,
+    // its owner may have returned already.
+    void Run(ImGuiGraphNode_ParallelBatch & batch, int chunk)
+    {
+        int const begin = ImMin(chunk * batch.chunk_size, batch.count);
+        int const end = ImMin(begin + batch.chunk_size, batch.count);
+        int const chunk_count = batch.chunk_count;
+
+        batch.run(batch.func, begin, end, chunk);
+        if (batch.done.fetch_add(1) + 1 == chunk_count)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done_cv.notify_all();
+        }
+    }
+
+    void WorkerMain()
+    {
+        for (;;)
+        {
+            ImGuiGraphNode_ParallelBatch * batch = nullptr;
+            int chunk;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                work_cv.wait(lock, [this]() { return quit || pending != nullptr; });
+                if (quit)
+                    return;
+                chunk = Claim(batch);
+            }
+            Run(*batch, chunk);
+        }
+    }
+};
+
+void ImGuiGraphNode_RunParallelBatch(ImGuiGraphNode_ParallelBatch & batch)
+{
+    static ImGuiGraphNode_ThreadPool pool;
+
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        batch.link = pool.pending;
+        pool.pending = &batch;
+    }
+    pool.work_cv.notify_all();
+    for (;;)
+    {
+        ImGuiGraphNode_ParallelBatch * own = &batch;
+        int chunk;
+
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            chunk = pool.Claim(own);
+        }
+        if (chunk < 0)
+            break;
+        pool.Run(batch, chunk);
+    }
+
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    pool.done_cv.wait(lock, [&batch]() { return batch.done.load() == batch.chunk_count; });
+}
+
+std::mutex & ImGuiGraphNode_GetGraphvizMutex()
+{
+    // graphviz relies on global state, so graphs are never built or laid out
+    // concurrently, whichever thread they run on.
+    static std::mutex mutex;
+    return mutex;
+}
+
+GVC_t * ImGuiGraphNode_CreateGraphvizContext()
+{
+#ifndef IMGUI_GRAPHNODE_NO_GRAPHVIZ
+    std::lock_guard<std::mutex> lock(ImGuiGraphNode_GetGraphvizMutex());
+    return gvContext();
+#else
+    return nullptr;
+#endif /* !IMGUI_GRAPHNODE_NO_GRAPHVIZ */
+}
+
+void ImGuiGraphNode_FreeGraphvizContext(GVC_t * gvcontext)
+{
+#ifndef IMGUI_GRAPHNODE_NO_GRAPHVIZ
+    std::lock_guard<std::mutex> lock(ImGuiGraphNode_GetGraphvizMutex());
+    gvFreeContext(gvcontext);
+#else
+    IM_UNUSED(gvcontext);
+#endif /* !IMGUI_GRAPHNODE_NO_GRAPHVIZ */
+}
+
+template <typename T, typename A>
+static size_t ImGuiGraphNode_VectorMemoryUsage(std::vector<T, A> const & v)
+{
+    return v.capacity() * sizeof(T);
+}
+
+static size_t ImGuiGraphNode_GraphMemoryUsage(ImGuiGraphNode_Graph const & graph)
+{
+    return graph.arena ? sizeof(ImGuiGraphNode_Arena) + graph.arena->capacity : 0;
+}
+
+static size_t ImGuiGraphNode_SubmissionMemoryUsage(ImGuiGraphNode_Submission const & submission)
+{
+    return ImGuiGraphNode_VectorMemoryUsage(submission.nodes)
+        + ImGuiGraphNode_VectorMemoryUsage(submission.edges)
+        + ImGuiGraphNode_VectorMemoryUsage(submission.strings);
+}
+
+// Heap bytes held by a cache, a pending layout job included. Small string
+// buffers and container bookkeeping are not accounted for.
+static size_t ImGuiGraphNode_ForceLayoutMemoryUsage(ImGuiGraphNode_ForceLayout const & layout)
+{
+    size_t bytes = ImGuiGraphNode_VectorMemoryUsage(layout.scratch) + ImGuiGraphNode_VectorMemoryUsage(layout.thread_energy);
+
+    for (auto const & scratch : layout.scratch)
+    {
+        bytes += ImGuiGraphNode_VectorMemoryUsage(scratch.ix) + ImGuiGraphNode_VectorMemoryUsage(scratch.iy)
+            + ImGuiGraphNode_VectorMemoryUsage(scratch.im) + ImGuiGraphNode_VectorMemoryUsage(scratch.stack);
+    }
+    return bytes + sizeof(layout)
+        + ImGuiGraphNode_VectorMemoryUsage(layout.posx) + ImGuiGraphNode_VectorMemoryUsage(layout.posy)
+        + ImGuiGraphNode_VectorMemoryUsage(layout.forcex) + ImGuiGraphNode_VectorMemoryUsage(layout.forcey)
+        + ImGuiGraphNode_VectorMemoryUsage(layout.mobility)
+        + ImGuiGraphNode_VectorMemoryUsage(layout.width) + ImGuiGraphNode_VectorMemoryUsage(layout.height)
+        + ImGuiGraphNode_VectorMemoryUsage(layout.adjacency_offsets) + ImGuiGraphNode_VectorMemoryUsage(layout.adjacency)
+        + ImGuiGraphNode_VectorMemoryUsage(layout.nodes) + ImGuiGraphNode_VectorMemoryUsage(layout.edges)
+        + ImGuiGraphNode_VectorMemoryUsage(layout.edgetail) + ImGuiGraphNode_VectorMemoryUsage(layout.edgehead)
+        + ImGuiGraphNode_VectorMemoryUsage(layout.cells) + ImGuiGraphNode_VectorMemoryUsage(layout.leaves)
+        + ImGuiGraphNode_VectorMemoryUsage(layout.order)
+        + ImGuiGraphNode_VectorMemoryUsage(layout.sortedx) + ImGuiGraphNode_VectorMemoryUsage(layout.sortedy);
+}
+
+size_t ImGuiGraphNode_GetCacheMemoryUsage(ImGuiGraphNodeContextCache const & cache)
+{
+    size_t bytes = sizeof(cache);
+
+    bytes += ImGuiGraphNode_SubmissionMemoryUsage(cache.submission);
+    bytes += ImGuiGraphNode_GraphMemoryUsage(cache.graph);
+    bytes += ImGuiGraphNode_VectorMemoryUsage(cache.drawnodes);
+    bytes += ImGuiGraphNode_VectorMemoryUsage(cache.drawedges);
+    bytes += ImGuiGraphNode_VectorMemoryUsage(cache.drawpoints);
+    bytes += ImGuiGraphNode_VectorMemoryUsage(cache.textsizes);
+    bytes += ImGuiGraphNode_VectorMemoryUsage(cache.hitgrid.items);
+    bytes += ImGuiGraphNode_VectorMemoryUsage(cache.hitgrid.cells);
+    bytes += ImGuiGraphNode_VectorMemoryUsage(cache.hitgrid.cellitems);
+    if (cache.progressive)
+        bytes += ImGuiGraphNode_ForceLayoutMemoryUsage(*cache.progressive);
+    if (cache.job)
+    {
+        // The job's graph is only written by the worker until it is done
+        bytes += sizeof(*cache.job) + ImGuiGraphNode_SubmissionMemoryUsage(cache.job->submission);
+        if (cache.job->done)
+            bytes += ImGuiGraphNode_GraphMemoryUsage(cache.job->graph);
+    }
+    return bytes;
+}
+
+static void ImGuiGraphNodeEvictCache(ImGuiGraphNodeContext & ctx, std::map<ImGuiID, ImGuiGraphNodeContextCache>::iterator it)
+{
+    // The worker may still hold the job, it will skip it
+    if (it->second.job)
+        it->second.job->cancelled = true;
+    ctx.graph_caches.erase(it);
+}
+
+// Evicts the caches of graphs not submitted for too long, then the least
+// recently used ones until the memory budget is met. Caches submitted during
+// the current frame are always kept.
+void ImGuiGraphNodeCollectCaches(ImGuiGraphNodeContext & ctx, int frame)
+{
+    size_t total = 0;
+
+    for (auto it = ctx.graph_caches.begin(); it != ctx.graph_caches.end();)
+    {
+        auto const next = std::next(it);
+
+        if (ctx.cache_max_unused_frames > 0 && frame - it->second.last_frame > ctx.cache_max_unused_frames)
+            ImGuiGraphNodeEvictCache(ctx, it);
+        else
+            total += it->second.memory_usage;
+        it = next;
+    }
+    if (ctx.cache_max_bytes == 0 || total <= ctx.cache_max_bytes)
+        return;
+
+    ImGuiGraphNode_Vector<std::pair<int, ImGuiID>> lru;
+
+    lru.reserve(ctx.graph_caches.size());
+    for (auto const & it : ctx.graph_caches)
+    {
+        if (it.second.last_frame != frame)
+            lru.push_back(std::make_pair(it.second.last_frame, it.first));
+    }
+    std::sort(lru.begin(), lru.end());
+    for (auto const & entry : lru)
+    {
+        if (total <= ctx.cache_max_bytes)
+            break;
+
+        auto const it = ctx.graph_caches.find(entry.second);
+
+        total -= it->second.memory_usage;
+        ImGuiGraphNodeEvictCache(ctx, it);
+    }
+}
+
+#ifndef IMGUI_GRAPHNODE_NO_GRAPHVIZ
+// True when b starts where a ends
+static bool ImGuiGraphNode_BeziersAreJoined(bezier const & a, bezier const & b)
+{
+    return a.list[a.size - 1].x == b.list[0].x && a.list[a.size - 1].y == b.list[0].y;
+}
+
+void ImGuiGraphNode_ReadGraphFromLayout(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission, graph_t * gvgraph, Agnode_t * const * gvnodes, Agedge_t * const * gvedges)
+{
+    // Coordinates are converted to inches relative to the bounding box, which
+    // is what the "plain" output format would give.
+    pointf const origin = GD_bb(gvgraph).LL;
+    pointf const end = GD_bb(gvgraph).UR;
+
+    graph.scale = 1.f;
+    graph.size.x = (float)PS2INCH(end.x - origin.x);
+    graph.size.y = (float)PS2INCH(end.y - origin.y);
+    graph.Reserve(submission.nodes.size(), submission.edges.size(), submission.strings.size());
+    for (size_t i = 0; i < submission.nodes.size(); ++i)
+    {
+        Agnode_t * const n = gvnodes[i];
+
+        if (n == nullptr)
+            continue;
+
+        ImGuiGraphNode_SubmittedNode const & submitted = submission.nodes[i];
+        ImVec2 const pos((float)PS2INCH(ND_coord(n).x - origin.x), (float)PS2INCH(ND_coord(n).y - origin.y));
+        ImVec2 const size((float)ND_width(n), (float)ND_height(n));
+
+        graph.AddNode(submitted.id, graph.AddString(submission.GetString(submitted.label)), pos, size, submitted.color, submitted.fillcolor);
+    }
+    for (size_t i = 0; i < submission.edges.size(); ++i)
+    {
+        Agedge_t * const e = gvedges[i];
+
+        if (e == nullptr || ED_spl(e) == nullptr)
+            continue;
+
+        ImGuiGraphNode_SubmittedEdge const & submitted = submission.edges[i];
+        splines const * const spl = ED_spl(e);
+        auto const topoint = [&origin](pointf const & p) { return ImVec2((float)PS2INCH(p.x - origin.x), (float)PS2INCH(p.y - origin.y)); };
+        bool cubic = spl->size > 0;
+        int count = 0;
+
+        for (int j = 0; j < spl->size; ++j)
+        {
+            cubic = cubic && spl->list[j].size >= 4 && (spl->list[j].size - 1) % 3 == 0;
+            count += spl->list[j].size;
+        }
+        // Consecutive beziers are joined into a single 3n+1 spline: a shared
+        // end point is kept once, a gap is bridged by a straight segment
+        for (int j = 1; cubic && j < spl->size; ++j)
+            count += ImGuiGraphNode_BeziersAreJoined(spl->list[j - 1], spl->list[j]) ? -1 : 2;
+        if (count < 2)
+            continue;
+        graph.AddEdge(submitted.id, submitted.tail, submitted.head, graph.AddString(submission.GetString(submitted.label)), submitted.color);
+
+        ImVec2 * const first = graph.AddEdgePoints(count);
+        ImVec2 * points = first;
+
+        for (int j = 0; j < spl->size; ++j)
+        {
+            bezier const & bz = spl->list[j];
+            int k = 0;
+
+            if (cubic && j > 0)
+            {
+                if (!ImGuiGraphNode_BeziersAreJoined(spl->list[j - 1], bz))
+                {
+                    ImVec2 const a = points[-1];
+                    ImVec2 const b = topoint(bz.list[0]);
+
+                    *points++ = ImVec2(a.x + (b.x - a.x) / 3.f, a.y + (b.y - a.y) / 3.f);
+                    *points++ = ImVec2(a.x + (b.x - a.x) * 2.f / 3.f, a.y + (b.y - a.y) * 2.f / 3.f);
+                    *points++ = b;
+                }
+                k = 1;
+            }
+            for (; k < bz.size; ++k)
+            {
+                *points++ = topoint(bz.list[k]);
+            }
+        }
+        IM_ASSERT(points == first + count);
+        if (ED_label(e))
+        {
+            graph.edge_label_pos.back().x = (float)PS2INCH(ED_label(e)->pos.x - origin.x);
+            graph.edge_label_pos.back().y = (float)PS2INCH(ED_label(e)->pos.y - origin.y);
+        }
+    }
+}
+#endif /* !IMGUI_GRAPHNODE_NO_GRAPHVIZ */
+
+// Only force directed engines honor initial positions
+bool ImGuiGraphNode_FillLayoutSeed(ImGuiGraphNode_LayoutSeed & seed, ImGuiGraphNode_Graph const & graph, ImGuiGraphNodeLayout layout, ImGuiGraphNodeFlags flags)
+{
+    seed.positions.clear();
+    seed.pinned = (flags & ImGuiGraphNodeFlags_PinPreviousNodes) != 0;
+    if (!(flags & ImGuiGraphNodeFlags_IncrementalLayout))
+        return false;
+    if (layout != ImGuiGraphNodeLayout_Neato && layout != ImGuiGraphNodeLayout_Fdp && layout != ImGuiGraphNodeLayout_Sfdp && layout != ImGuiGraphNodeLayout_ForceDirected)
+        return false;
+    seed.positions.reserve(graph.node_ids.size());
+    for (int i = 0; i < graph.GetNodeCount(); ++i)
+        seed.positions.push_back(std::make_pair(graph.node_ids[i], graph.node_pos[i]));
+    std::sort(seed.positions.begin(), seed.positions.end(), [](std::pair<ImGuiID, ImVec2> const & a, std::pair<ImGuiID, ImVec2> const & b) { return a.first < b.first; });
+    return !seed.positions.empty();
+}
+
+void ImGuiGraphNodeRenderGraphLayout(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission, GVC_t * gvcontext, ImGuiGraphNode_LayoutSeed const * seed)
+{
+    // Built-in engines don't go through graphviz, nor its lock
+    switch (submission.layout)
+    {
+        case ImGuiGraphNodeLayout_ForceDirected:
+            ImGuiGraphNodeRenderForceDirectedLayout(graph, submission, seed);
+            return;
+        case ImGuiGraphNodeLayout_Layered:
+            ImGuiGraphNodeRenderLayeredLayout(graph, submission);
+            return;
+        case ImGuiGraphNodeLayout_Tree:
+            if (ImGuiGraphNodeRenderTreeLayout(graph, submission))
+                return;
+            break;
+        default:
+            break;
+    }
+
+#ifdef IMGUI_GRAPHNODE_NO_GRAPHVIZ
+    // Graphviz engines are replaced by the closest built-in one
+    IM_UNUSED(gvcontext);
+    if (submission.layout == ImGuiGraphNodeLayout_Dot || submission.layout == ImGuiGraphNodeLayout_Tree)
+        ImGuiGraphNodeRenderLayeredLayout(graph, submission);
+    else
+        ImGuiGraphNodeRenderForceDirectedLayout(graph, submission, seed);
+#else
+    char const * const engine = submission.layout == ImGuiGraphNodeLayout_Tree ? "dot" : ImGuiGraphNode_GetEngineNameFromLayoutEnum(submission.layout);
+    int ok = 0;
+    // cgraph and the layout engines share global state, the lock is only
+    // released while the results are read from the graph's own records
+    std::unique_lock<std::mutex> lock(ImGuiGraphNode_GetGraphvizMutex());
+    // Elements submitted more than once map to nullptr, only their first
+    // occurrence is laid out.
+    ImGuiGraphNode_Vector<Agnode_t *> gvnodes(submission.nodes.size(), nullptr);
+    ImGuiGraphNode_Vector<Agedge_t *> gvedges(submission.edges.size(), nullptr);
+
+    graph.Clear();
+    IM_ASSERT(gvcontext != nullptr);
+    graph_t * const gvgraph = agopen(const_cast<char *>("g"), Agdirected, 0);
+    // Seeded positions are written in points, neato and fdp read inches
+    // unless told otherwise
+    if (seed)
+        agattr(gvgraph, AGRAPH, (char *)"inputscale", (char *)"72");
+    for (size_t i = 0; i < submission.nodes.size(); ++i)
+    {
+        ImGuiGraphNode_SubmittedNode const & node = submission.nodes[i];
+        auto const name = ImGuiIDToString(node.id);
+
+        if (agnode(gvgraph, const_cast<char *>((char const *)name), 0) != nullptr)
+            continue;
+
+        Agnode_t * const n = agnode(gvgraph, const_cast<char *>((char const *)name), 1);
+        IM_ASSERT(n != nullptr);
+        agsafeset(n, (char *)"label", submission.GetString(node.label), "");
+        if (seed)
+        {
+            auto const it = std::lower_bound(seed->positions.begin(), seed->positions.end(), node.id, [](std::pair<ImGuiID, ImVec2> const & a, ImGuiID id) { return a.first < id; });
+
+            if (it != seed->positions.end() && it->first == node.id)
+            {
+                char pos[64];
+
+                // Whole points are precise enough and locale independent,
+                // "!" keeps the node at this position
+                sprintf(pos, "%d,%d%s", (int)ImFloor((float)INCH2PS(it->second.x) + .5f), (int)ImFloor((float)INCH2PS(it->second.y) + .5f), seed->pinned ? "!" : "");
+                agsafeset(n, (char *)"pos", pos, "");
+            }
+        }
+#ifdef IMGUI_GRAPHNODE_USE_PLAIN_RENDER
+        agsafeset(n, (char *)"color", ImU32ColorToString(node.color), "");
+        agsafeset(n, (char *)"fillcolor", ImU32ColorToString(node.fillcolor), "");
+#endif /* IMGUI_GRAPHNODE_USE_PLAIN_RENDER */
+        gvnodes[i] = n;
+    }
+    for (size_t i = 0; i < submission.edges.size(); ++i)
+    {
+        ImGuiGraphNode_SubmittedEdge const & edge = submission.edges[i];
+        Agnode_t * const a = agnode(gvgraph, ImGuiIDToString(edge.tail), 0);
+        Agnode_t * const b = agnode(gvgraph, ImGuiIDToString(edge.head), 0);
+        IM_ASSERT(a != nullptr);
+        IM_ASSERT(b != nullptr);
+        auto const name = ImGuiIDToString(edge.name);
+
+        if (agedge(gvgraph, a, b, const_cast<char *>((char const *)name), 0) != nullptr)
+            continue;
+
+        Agedge_t * const e = agedge(gvgraph, a, b, const_cast<char *>((char const *)name), 1);
+        IM_ASSERT(e != nullptr);
+        agsafeset(e, (char *)"label", submission.GetString(edge.label), "");
+#ifdef IMGUI_GRAPHNODE_USE_PLAIN_RENDER
+        char identifier[16];
+        sprintf(identifier, "#%x", edge.id);
+        // graphviz library doesn't serialize the edge's identifier, so we use the
+        // color field to store the ImGuiID, which will later be used to retrieve
+        // the edge's properties.
+        agsafeset(e, (char *)"color", identifier, "");
+#endif /* IMGUI_GRAPHNODE_USE_PLAIN_RENDER */
+        gvedges[i] = e;
+    }
+    agattr(gvgraph, AGEDGE, (char *)"dir", "none");
+    ok = gvLayout(gvcontext, gvgraph, engine);
+    IM_ASSERT(ok == 0);
+#ifdef IMGUI_GRAPHNODE_USE_PLAIN_RENDER
+    char * data = nullptr;
+    size_t size = 0;
+    ok = gvRenderData(gvcontext, gvgraph, "plain", &data, &size);
+    IM_ASSERT(ok == 0);
+    lock.unlock();
+    if (!ImGuiGraphNode_ReadGraphFromMemory(graph, submission, data, size))
+    {
+        graph.Clear();
+    }
+    lock.lock();
+    gvFreeRenderData(data);
+#else
+    lock.unlock();
+    ImGuiGraphNode_ReadGraphFromLayout(graph, submission, gvgraph, gvnodes.data(), gvedges.data());
+    lock.lock();
+#endif /* IMGUI_GRAPHNODE_USE_PLAIN_RENDER */
+    gvFreeLayout(gvcontext, gvgraph);
+    agclose(gvgraph);
+#endif /* IMGUI_GRAPHNODE_NO_GRAPHVIZ */
+}
+
+static void ImGuiGraphNodeLayoutWorkerMain(ImGuiGraphNodeContext * ctx)
+{
+    GVC_t * const gvcontext = ImGuiGraphNode_CreateGraphvizContext();
+
+    for (;;)
+    {
+        std::shared_ptr<ImGuiGraphNode_LayoutJob> job;
+
+        {
+            std::unique_lock<std::mutex> lock(ctx->worker_mutex);
+            ctx->worker_cv.wait(lock, [ctx]() { return ctx->worker_quit || !ctx->worker_queue.empty(); });
+            if (ctx->worker_quit)
+                break;
+            job = std::move(ctx->worker_queue.front());
+            ctx->worker_queue.pop_front();
+        }
+        // A job is cancelled when its graph changed again before the job was
+        // picked up, there is no point in computing an outdated layout.
+        if (!job->cancelled)
+        {
+            ImGuiGraphNodeComputeGraphLayout(*ctx, job->graph, job->submission, gvcontext, job->seeded ? &job->seed : nullptr);
+        }
+        job->done = true;
+    }
+    ImGuiGraphNode_FreeGraphvizContext(gvcontext);
+}
+
+// Layout cache file: header, nodes, edges, edge points then label strings.
+// Files are written in native byte order, they are not meant to be shared
+// between machines.
+#define IMGUI_GRAPHNODE_CACHE_FILE_VERSION 1
+
+struct ImGuiGraphNode_CacheFileHeader
+{
+    char magic[4];
+    ImU32 version;
+    ImU64 key;
+    ImU32 node_count;
+    ImU32 edge_count;
+    ImU32 point_count;
+    ImU32 string_size;
+    ImVec2 size;
+    float scale;
+};
+
+struct ImGuiGraphNode_CacheFileNode
+{
+    ImGuiID id;
+    ImU32 color;
+    ImU32 fillcolor;
+    ImU32 label; // offset in the strings
+    ImU32 label_size;
+    ImVec2 pos;
+    ImVec2 size;
+};
+
+struct ImGuiGraphNode_CacheFileEdge
+{
+    ImGuiID id;
+    ImGuiID tail;
+    ImGuiID head;
+    ImU32 color;
+    ImU32 label; // offset in the strings
+    ImU32 label_size;
+    ImU32 points; // offset in the points
+    ImU32 point_count;
+    ImVec2 labelPos;
+};
+
+static char const ImGuiGraphNode_CacheFileMagic[4] = { 'I', 'G', 'N', 'L' };
+
+// Everything the layout depends on or copies into the graph. Unlike the
+// graph id, this doesn't depend on the address of retained graphs and is
+// stable between runs.
+ImU64 ImGuiGraphNode_HashSubmission(ImGuiGraphNode_Submission const & submission)
+{
+    ImU64 hash = ImGuiGraphNode_HashData(&submission.layout, sizeof(submission.layout), 0);
+
+    for (auto const & node : submission.nodes)
+    {
+        char const * const label = submission.GetString(node.label);
+
+        hash = ImGuiGraphNode_HashData(&node.id, sizeof(node.id), hash);
+        hash = ImGuiGraphNode_HashData(&node.color, sizeof(node.color), hash);
+        hash = ImGuiGraphNode_HashData(&node.fillcolor, sizeof(node.fillcolor), hash);
+        hash = ImGuiGraphNode_HashData(label, strlen(label) + 1, hash);
+    }
+    for (auto const & edge : submission.edges)
+    {
+        char const * const label = submission.GetString(edge.label);
+
+        hash = ImGuiGraphNode_HashData(&edge.id, sizeof(edge.id), hash);
+        hash = ImGuiGraphNode_HashData(&edge.name, sizeof(edge.name), hash);
+        hash = ImGuiGraphNode_HashData(&edge.tail, sizeof(edge.tail), hash);
+        hash = ImGuiGraphNode_HashData(&edge.head, sizeof(edge.head), hash);
+        hash = ImGuiGraphNode_HashData(&edge.color, sizeof(edge.color), hash);
+        hash = ImGuiGraphNode_HashData(label, strlen(label) + 1, hash);
+    }
+    return hash;
+}
+
+template <typename T>
+static void ImGuiGraphNode_AppendBytes(ImGuiGraphNode_Vector<char> & out, T const & value)
+{
+    char const * const bytes = reinterpret_cast<char const *>(&value);
+
+    out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+void ImGuiGraphNode_WriteGraphToCache(ImGuiGraphNode_Graph const & graph, ImU64 key, ImGuiGraphNode_Vector<char> & out)
+{
+    ImGuiGraphNode_CacheFileHeader header;
+    int const node_count = graph.GetNodeCount();
+    int const edge_count = graph.GetEdgeCount();
+
+    memset((void *)&header, 0, sizeof(header));
+    memcpy(header.magic, ImGuiGraphNode_CacheFileMagic, sizeof(header.magic));
+    header.version = IMGUI_GRAPHNODE_CACHE_FILE_VERSION;
+    header.key = key;
+    header.node_count = (ImU32)node_count;
+    header.edge_count = (ImU32)edge_count;
+    header.point_count = (ImU32)graph.points.size();
+    header.string_size = (ImU32)graph.strings.buffer.size();
+    header.size = graph.size;
+    header.scale = graph.scale;
+
+    // Points and strings are stored as they are in memory, labels referring
+    // to the pool
+    out.clear();
+    out.reserve(sizeof(header) + node_count * sizeof(ImGuiGraphNode_CacheFileNode) + edge_count * sizeof(ImGuiGraphNode_CacheFileEdge)
+        + graph.points.size() * sizeof(ImVec2) + graph.strings.buffer.size());
+    out.resize(sizeof(header));
+    memcpy(out.data(), &header, sizeof(header));
+    for (int i = 0; i < node_count; ++i)
+    {
+        ImGuiGraphNode_CacheFileNode filenode;
+
+        memset((void *)&filenode, 0, sizeof(filenode));
+        filenode.id = graph.node_ids[i];
+        filenode.color = graph.node_colors[i];
+        filenode.fillcolor = graph.node_fillcolors[i];
+        filenode.label = (ImU32)graph.node_labels[i];
+        filenode.label_size = (ImU32)strlen(graph.GetString(graph.node_labels[i]));
+        filenode.pos = graph.node_pos[i];
+        filenode.size = graph.node_sizes[i];
+        ImGuiGraphNode_AppendBytes(out, filenode);
+    }
+    for (int i = 0; i < edge_count; ++i)
+    {
+        ImGuiGraphNode_CacheFileEdge fileedge;
+
+        memset((void *)&fileedge, 0, sizeof(fileedge));
+        fileedge.id = graph.edge_ids[i];
+        fileedge.tail = graph.edge_tails[i];
+        fileedge.head = graph.edge_heads[i];
+        fileedge.color = graph.edge_colors[i];
+        fileedge.label = (ImU32)graph.edge_labels[i];
+        fileedge.label_size = (ImU32)strlen(graph.GetString(graph.edge_labels[i]));
+        fileedge.points = (ImU32)graph.edge_points[i];
+        fileedge.point_count = (ImU32)graph.GetEdgePointCount(i);
+        fileedge.labelPos = graph.edge_label_pos[i];
+        ImGuiGraphNode_AppendBytes(out, fileedge);
+    }
+    out.insert(out.end(), reinterpret_cast<char const *>(graph.points.data()), reinterpret_cast<char const *>(graph.points.data() + graph.points.size()));
+    out.insert(out.end(), graph.strings.buffer.begin(), graph.strings.buffer.end());
+}
+
+// Fails on anything that doesn't look like a complete file for this key,
+// graph is only valid when true is returned.
+bool ImGuiGraphNode_ReadGraphFromCache(ImGuiGraphNode_Graph & graph, ImU64 key, void const * data, size_t size)
+{
+    char const * const bytes = static_cast<char const *>(data);
+    ImGuiGraphNode_CacheFileHeader header;
+
+    if (size < sizeof(header))
+        return false;
+    memcpy(&header, bytes, sizeof(header));
+    if (memcmp(header.magic, ImGuiGraphNode_CacheFileMagic, sizeof(header.magic)) != 0
+        || header.version != IMGUI_GRAPHNODE_CACHE_FILE_VERSION
+        || header.key != key)
+        return false;
+
+    size_t const nodes_offset = sizeof(header);
+    size_t const edges_offset = nodes_offset + (size_t)header.node_count * sizeof(ImGuiGraphNode_CacheFileNode);
+    size_t const points_offset = edges_offset + (size_t)header.edge_count * sizeof(ImGuiGraphNode_CacheFileEdge);
+    size_t const strings_offset = points_offset + (size_t)header.point_count * sizeof(ImVec2);
+    char const * const strings = bytes + strings_offset;
+
+    if (strings_offset + header.string_size != size)
+        return false;
+
+    graph.Clear();
+    graph.size = header.size;
+    graph.scale = header.scale;
+    graph.Reserve(header.node_count, header.edge_count, header.string_size);
+    for (ImU32 i = 0; i < header.node_count; ++i)
+    {
+        ImGuiGraphNode_CacheFileNode filenode;
+
+        memcpy(&filenode, bytes + nodes_offset + i * sizeof(filenode), sizeof(filenode));
+        if ((size_t)filenode.label + filenode.label_size > header.string_size)
+            return false;
+        graph.AddNode(filenode.id, graph.AddString(strings + filenode.label, strings + filenode.label + filenode.label_size), filenode.pos, filenode.size, filenode.color, filenode.fillcolor);
+    }
+    // Edge points follow each other, they are copied at once
+    ImU32 point_end = 0;
+
+    for (ImU32 i = 0; i < header.edge_count; ++i)
+    {
+        ImGuiGraphNode_CacheFileEdge fileedge;
+
+        memcpy(&fileedge, bytes + edges_offset + i * sizeof(fileedge), sizeof(fileedge));
+        if ((size_t)fileedge.label + fileedge.label_size > header.string_size
+            || fileedge.points != point_end
+            || (size_t)fileedge.points + fileedge.point_count > header.point_count
+            || fileedge.point_count < 2)
+            return false;
+        graph.AddEdge(fileedge.id, fileedge.tail, fileedge.head, graph.AddString(strings + fileedge.label, strings + fileedge.label + fileedge.label_size), fileedge.color);
+        graph.edge_label_pos.back() = fileedge.labelPos;
+        point_end = fileedge.points + fileedge.point_count;
+        graph.edge_points.back() = (int)point_end;
+    }
+    if (point_end != header.point_count)
+        return false;
+    graph.points.resize(header.point_count);
+    memcpy(graph.points.data(), bytes + points_offset, header.point_count * sizeof(ImVec2));
+    return true;
+}
+
+bool ImGuiGraphNode_LoadGraphCacheFile(ImGuiGraphNode_Graph & graph, ImU64 key, char const * path)
+{
+    bool ok = false;
+#ifdef _WIN32
+    FILE * const file = fopen(path, "rb");
+
+    if (file == nullptr)
+        return false;
+
+    ImGuiGraphNode_Vector<char> data;
+    char buffer[4096];
+    size_t read;
+
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data.insert(data.end(), buffer, buffer + read);
+    fclose(file);
+    ok = ImGuiGraphNode_ReadGraphFromCache(graph, key, data.data(), data.size());
+#else
+    int const fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        void * const data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data != MAP_FAILED)
+        {
+            ok = ImGuiGraphNode_ReadGraphFromCache(graph, key, data, (size_t)st.st_size);
+            munmap(data, (size_t)st.st_size);
+        }
+    }
+    close(fd);
+#endif /* _WIN32 */
+    if (!ok)
+        graph.Clear();
+    return ok;
+}
+
+// Written to a temporary file first, so that concurrent writers and readers
+// of the same key never see a partial file.
+bool ImGuiGraphNode_SaveGraphCacheFile(ImGuiGraphNode_Graph const & graph, ImU64 key, char const * path)
+{
+    static std::atomic<unsigned> counter { 0 };
+    ImGuiGraphNode_Vector<char> data;
+    char suffix[64];
+
+    ImGuiGraphNode_WriteGraphToCache(graph, key, data);
+    ImFormatString(suffix, sizeof(suffix), ".%u.%u.tmp", (unsigned)std::hash<std::thread::id>()(std::this_thread::get_id()), counter++);
+
+    std::string const temp = std::string(path) + suffix;
+    FILE * const file = fopen(temp.c_str(), "wb");
+
+    if (file == nullptr)
+        return false;
+
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+
+    ok = fclose(file) == 0 && ok;
+    ok = ok && rename(temp.c_str(), path) == 0;
+    if (!ok)
+        remove(temp.c_str());
+    return ok;
+}
+
+// Layout through the context's disk cache when it is enabled
+void ImGuiGraphNodeComputeGraphLayout(ImGuiGraphNodeContext & ctx, ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission, GVC_t * gvcontext, ImGuiGraphNode_LayoutSeed const * seed)
+{
+    std::string path;
+
+    {
+        std::lock_guard<std::mutex> lock(ctx.diskcache_mutex);
+        path = ctx.diskcache_directory;
+    }
+    if (path.empty())
+    {
+        ImGuiGraphNodeRenderGraphLayout(graph, submission, gvcontext, seed);
+        return;
+    }
+
+    ImU64 key = ImGuiGraphNode_HashSubmission(submission);
+
+    // Seeded layouts depend on the previous one
+    if (seed && !seed->positions.empty())
+    {
+        key = ImGuiGraphNode_HashData(seed->positions.data(), seed->positions.size() * sizeof(seed->positions[0]), key);
+        key = ImGuiGraphNode_HashData(&seed->pinned, sizeof(seed->pinned), key);
+    }
+    char filename[32];
+
+    ImFormatString(filename, sizeof(filename), "/%016llx.ignl", (unsigned long long)key);
+    path += filename;
+    if (ImGuiGraphNode_LoadGraphCacheFile(graph, key, path.c_str()))
+    {
+        ++ctx.diskcache_hits;
+        return;
+    }
+    ++ctx.diskcache_misses;
+    ImGuiGraphNodeRenderGraphLayout(graph, submission, gvcontext, seed);
+    // A failed layout leaves an empty graph, don't make it stick
+    if (!graph.node_ids.empty() || submission.nodes.empty())
+        ImGuiGraphNode_SaveGraphCacheFile(graph, key, path.c_str());
+}
+
+// Lays out independent graphs on a set of threads, each with its own graphviz
+// context. Threads pick the next graph as soon as they are done with one.
+void ImGuiGraphNodeRenderGraphLayouts(ImGuiGraphNodeContext & ctx, ImGuiGraphNode_Graph * graphs, ImGuiGraphNode_Submission const * submissions, int count, int num_threads)
+{
+    std::atomic<int> next { 0 };
+    auto const work = [&]()
+    {
+        GVC_t * const gvcontext = ImGuiGraphNode_CreateGraphvizContext();
+
+        for (int i = next++; i < count; i = next++)
+        {
+            ImGuiGraphNodeComputeGraphLayout(ctx, graphs[i], submissions[i], gvcontext);
+        }
+        ImGuiGraphNode_FreeGraphvizContext(gvcontext);
+    };
+
+    if (num_threads <= 0)
+        num_threads = ImMax((int)std::thread::hardware_concurrency(), 1);
+    num_threads = ImMin(num_threads, count);
+
+    ImGuiGraphNode_Vector<std::thread> threads;
+
+    // The calling thread takes its share of the work too
+    threads.reserve(ImMax(num_threads - 1, 0));
+    for (int i = 1; i < num_threads; ++i)
+        threads.emplace_back(work);
+    if (num_threads > 0)
+        work();
+    for (auto & thread : threads)
+        thread.join();
+}
+
+void ImGuiGraphNodeStartLayoutWorker(ImGuiGraphNodeContext & ctx)
+{
+    if (!ctx.worker.joinable())
+    {
+        ctx.worker_quit = false;
+        ctx.worker = std::thread(ImGuiGraphNodeLayoutWorkerMain, &ctx);
+    }
+}
+
+void ImGuiGraphNodeStopLayoutWorker(ImGuiGraphNodeContext & ctx)
+{
+    if (ctx.worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(ctx.worker_mutex);
+            ctx.worker_quit = true;
+            for (auto & job : ctx.worker_queue)
+                job->cancelled = true;
+            ctx.worker_queue.clear();
+        }
+        ctx.worker_cv.notify_all();
+        ctx.worker.join();
+    }
+}
+
+void ImGuiGraphNodeQueueLayoutJob(ImGuiGraphNodeContext & ctx, ImGuiGraphNodeContextCache & cache, ImGuiGraphNode_Submission const & submission, ImGuiGraphNode_LayoutSeed const * seed)
+{
+    if (cache.job)
+    {
+        cache.job->cancelled = true;
+    }
+    cache.job = std::make_shared<ImGuiGraphNode_LayoutJob>();
+    cache.job->submission = submission;
+    cache.job->seeded = seed != nullptr;
+    if (seed)
+        cache.job->seed = *seed;
+    ImGuiGraphNodeStartLayoutWorker(ctx);
+    {
+        std::lock_guard<std::mutex> lock(ctx.worker_mutex);
+        ctx.worker_queue.push_back(cache.job);
+    }
+    ctx.worker_cv.notify_one();
 }
@@ -6,47 +6,220 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <tuple>
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <type_traits>
 
+#ifndef IMGUI_GRAPHNODE_NO_GRAPHVIZ
 extern "C"
 {
 #include <gvc.h>
 }
+#else
+typedef struct GVC_s GVC_t; // never created, graphviz contexts are NULL
+#endif /* !IMGUI_GRAPHNODE_NO_GRAPHVIZ */
 
 #include "imgui_graphnode.h"
 #include "imgui_internal.h"
 
-#define IMGUI_GRAPHNODE_CREATE_LABEL_ALLOCA(_name, _label) \
-    char * _name; \
-    do { \
-        char const * const end = ImGui::FindRenderedTextEnd(_label); \
-        size_t const size = end - _label; \
-        _name = (char *)alloca(size + 1); \
-        memcpy(_name, _label, size); \
-        _name[size] = '\0'; \
-    } while(0)
+// Upper bounds of the adaptive tessellation: number of points of a node's
+// outline, and number of points per cubic segment of an edge.
+#define IMGUI_GRAPHNODE_DRAW_NODE_PATH_COUNT 64
+#define IMGUI_GRAPHNODE_DRAW_EDGE_PATH_COUNT 32
 
-#define IMGUI_GRAPHNODE_DRAW_NODE_PATH_COUNT 32
-#define IMGUI_GRAPHNODE_DRAW_EDGE_PATH_COUNT 64
+// Smallest number of edges worth a thread when filling draw buffers
+#define IMGUI_GRAPHNODE_DRAW_EDGES_PER_THREAD 4096
 
-struct ImGuiGraphNode_Node
+// Node outlines have 8, 16, 32 or 64 points, see ImGuiGraphNode_EllipseTable
+#define IMGUI_GRAPHNODE_DRAW_NODE_LOD_COUNT 4
+#define IMGUI_GRAPHNODE_DRAW_NODE_PATH_MIN_COUNT (IMGUI_GRAPHNODE_DRAW_NODE_PATH_COUNT >> (IMGUI_GRAPHNODE_DRAW_NODE_LOD_COUNT - 1))
+
+// NEON kernels on ARM, the SSE ones use imgui's IMGUI_ENABLE_SSE
+#if !defined(IMGUI_GRAPHNODE_DISABLE_NEON) && (defined(__ARM_NEON) || defined(_M_ARM64))
+#define IMGUI_GRAPHNODE_ENABLE_NEON
+#include <arm_neon.h>
+#endif /* IMGUI_GRAPHNODE_DISABLE_NEON */
+
+// Smallest block an arena allocates
+#define IMGUI_GRAPHNODE_ARENA_BLOCK_SIZE (64 * 1024)
+
+// Heap allocations made by the library containers, for all contexts and
+// threads. Arena blocks are counted, not the allocations they serve.
+struct ImGuiGraphNode_AllocationCounters
 {
-    std::string name;
-    std::string label;
-    ImVec2 pos;
-    ImVec2 size;
-    ImU32 color;
-    ImU32 fillcolor;
+    std::atomic<size_t> allocations { 0 };
+    std::atomic<size_t> frees { 0 };
+    std::atomic<size_t> bytes { 0 }; // currently allocated
 };
 
-struct ImGuiGraphNode_Edge
+struct ImGuiGraphNode_ArenaBlock
 {
-    std::vector<ImVec2> points;
-    std::string tail;
-    std::string head;
-    std::string label;
-    ImVec2 labelPos;
-    ImU32 color;
-    ImGuiID id;
+    ImGuiGraphNode_ArenaBlock * prev;
+    size_t size; // bytes following this header
+};
+
+// Linear allocator: memory is bumped out of blocks and only released all at
+// once by Reset(). Blocks are merged into a single one on reset, so that a
+// workload which doesn't grow stops allocating, and a block that is mostly
+// unused is released like ImGuiGraphNode_TrimVector() does.
+struct ImGuiGraphNode_Arena
+{
+    ImGuiGraphNode_ArenaBlock * block = nullptr; // current block, previous ones are chained
+    size_t offset = 0; // bytes used in the current block
+    size_t used = 0; // bytes allocated since the last reset
+    size_t last_used = 0; // bytes allocated between the last two resets
+    size_t capacity = 0; // bytes held by all blocks
+    size_t next_block_size = 0; // at least the last use after a merge
+
+    ImGuiGraphNode_Arena() = default;
+    ImGuiGraphNode_Arena(ImGuiGraphNode_Arena const &) = delete;
+    ImGuiGraphNode_Arena & operator=(ImGuiGraphNode_Arena const &) = delete;
+    ~ImGuiGraphNode_Arena() { Release(); }
+
+    void * Alloc(size_t size, size_t align);
+    void Reset();
+    void Release();
+};
+
+IMGUI_API void * ImGuiGraphNode_HeapAlloc(size_t size);
+IMGUI_API void ImGuiGraphNode_HeapFree(void * ptr, size_t size);
+
+// Arenas owned through a pointer are allocated from the counted heap too
+struct ImGuiGraphNode_ArenaDeleter
+{
+    void operator()(ImGuiGraphNode_Arena * arena) const;
+};
+
+typedef std::unique_ptr<ImGuiGraphNode_Arena, ImGuiGraphNode_ArenaDeleter> ImGuiGraphNode_ArenaPtr;
+
+IMGUI_API ImGuiGraphNode_ArenaPtr ImGuiGraphNode_NewArena();
+
+// Allocates from an arena when given one and from the counted heap otherwise.
+// Arena memory is never freed one allocation at a time. Copies of a container
+// go to the heap, as they may outlive the arena of the original.
+template <typename T>
+struct ImGuiGraphNode_Allocator
+{
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    ImGuiGraphNode_Arena * arena = nullptr;
+
+    ImGuiGraphNode_Allocator() = default;
+    explicit ImGuiGraphNode_Allocator(ImGuiGraphNode_Arena * arena) : arena(arena) {}
+    template <typename U>
+    ImGuiGraphNode_Allocator(ImGuiGraphNode_Allocator<U> const & other) : arena(other.arena) {}
+
+    T * allocate(size_t n)
+    {
+        return static_cast<T *>(arena ? arena->Alloc(n * sizeof(T), alignof(T)) : ImGuiGraphNode_HeapAlloc(n * sizeof(T)));
+    }
+    void deallocate(T * p, size_t n)
+    {
+        if (arena == nullptr)
+            ImGuiGraphNode_HeapFree(p, n * sizeof(T));
+    }
+    ImGuiGraphNode_Allocator select_on_container_copy_construction() const { return ImGuiGraphNode_Allocator(); }
+};
+
+template <typename T, typename U>
+bool operator==(ImGuiGraphNode_Allocator<T> const & a, ImGuiGraphNode_Allocator<U> const & b) { return a.arena == b.arena; }
+template <typename T, typename U>
+bool operator!=(ImGuiGraphNode_Allocator<T> const & a, ImGuiGraphNode_Allocator<U> const & b) { return a.arena != b.arena; }
+
+template <typename T>
+using ImGuiGraphNode_Vector = std::vector<T, ImGuiGraphNode_Allocator<T>>;
+
+// Leaves the elements added by resize() uninitialized, for buffers that are
+// grown once and then entirely written, possibly from several threads
+template <typename T>
+struct ImGuiGraphNode_NoInitAllocator : ImGuiGraphNode_Allocator<T>
+{
+    ImGuiGraphNode_NoInitAllocator() = default;
+    template <typename U>
+    ImGuiGraphNode_NoInitAllocator(ImGuiGraphNode_NoInitAllocator<U> const & other) : ImGuiGraphNode_Allocator<T>(other) {}
+
+    template <typename U>
+    void construct(U *) {}
+    template <typename U, typename... Args>
+    void construct(U * p, Args &&... args) { ::new ((void *)p) U(std::forward<Args>(args)...); }
+    ImGuiGraphNode_NoInitAllocator select_on_container_copy_construction() const { return ImGuiGraphNode_NoInitAllocator(); }
+};
+
+template <typename T>
+using ImGuiGraphNode_NoInitVector = std::vector<T, ImGuiGraphNode_NoInitAllocator<T>>;
+
+// Drops the storage of v, which is left empty and allocating from arena
+template <typename T>
+void ImGuiGraphNode_ResetVector(ImGuiGraphNode_Vector<T> & v, ImGuiGraphNode_Arena * arena)
+{
+    v = ImGuiGraphNode_Vector<T>(ImGuiGraphNode_Allocator<T>(arena));
+}
+
+// One ImGuiGraphNode_ParallelFor() call: chunk c covers
+// [c * chunk_size, (c + 1) * chunk_size) clamped to count. It lives on the
+// caller's stack, the pool only links it while chunks are left to start.
+struct ImGuiGraphNode_ParallelBatch
+{
+    void (*run)(void const * func, int begin, int end, int chunk);
+    void const * func;
+    int count;
+    int chunk_size;
+    int chunk_count;
+    int next = 0; // next chunk to start, guarded by the pool mutex
+    std::atomic<int> done { 0 };
+    ImGuiGraphNode_ParallelBatch * link = nullptr;
+};
+
+// Runs the chunks of batch on the calling thread and the threads of a pool
+// shared by the whole process, created on first use, and returns once they
+// are all done.
+IMGUI_API void ImGuiGraphNode_RunParallelBatch(ImGuiGraphNode_ParallelBatch & batch);
+
+// Splits [0, count) in contiguous ranges, one per thread and at least grain
+// items each. Small inputs stay on the calling thread, where waking workers
+// would cost more than it saves.
+template <typename F>
+void ImGuiGraphNode_ParallelFor(int count, int num_threads, F const & func, int grain)
+{
+    num_threads = ImClamp(num_threads, 1, ImMax(count / grain, 1));
+    if (num_threads == 1)
+    {
+        func(0, count, 0);
+        return;
+    }
+
+    ImGuiGraphNode_ParallelBatch batch;
+
+    batch.run = [](void const * f, int begin, int end, int chunk) { (*static_cast<F const *>(f))(begin, end, chunk); };
+    batch.func = &func;
+    batch.count = count;
+    batch.chunk_size = (count + num_threads - 1) / num_threads;
+    batch.chunk_count = num_threads;
+    ImGuiGraphNode_RunParallelBatch(batch);
+}
+
+// Null terminated strings packed in a single buffer and referenced by their
+// offset. Equal strings are stored once, an open addressing table of offsets
+// finds them without allocating per string.
+struct ImGuiGraphNode_StringPool
+{
+    ImGuiGraphNode_Vector<char> buffer;
+    ImGuiGraphNode_Vector<int> slots; // offsets in buffer, -1 for empty slots
+    int count = 0;
+
+    void Reset(ImGuiGraphNode_Arena * arena);
+    void Reserve(int string_count, size_t size);
+    int Add(char const * begin, char const * end);
+    int Add(char const * str) { return Add(str, str + strlen(str)); }
+    char const * Get(int offset) const { return buffer.data() + offset; }
 };
 
 struct ImGuiGraphNode_EdgeInfo
@@ -59,19 +232,146 @@ struct ImGuiGraphNode_EdgeRectangle
     ImVec2 a, b, c, d;
 };
 
+// Laid out graph as parallel arrays, node_*[i] describing the i-th node and
+// edge_*[i] the i-th edge. The control points of all edges are kept in one
+// buffer, those of edge i being [edge_points[i], edge_points[i + 1]).
+// Everything lives in the graph's arena, which Clear() resets. The arena is
+// only created by the first Reserve() or Add*(), so graphs that stay empty
+// don't allocate.
 struct ImGuiGraphNode_Graph
 {
-    std::map<ImGuiID, ImRect> nodesBB;
-    std::map<ImGuiID, std::vector<ImGuiGraphNode_EdgeRectangle>> edgesRectangle;
-    std::vector<ImGuiGraphNode_Node> nodes;
-    std::vector<ImGuiGraphNode_Edge> edges;
+    ImGuiGraphNode_ArenaPtr arena; // holds all the arrays, moved along with them
+    ImGuiGraphNode_Vector<ImGuiID> node_ids;
+    ImGuiGraphNode_Vector<int> node_labels; // offsets in strings
+    ImGuiGraphNode_Vector<ImVec2> node_pos;
+    ImGuiGraphNode_Vector<ImVec2> node_sizes;
+    ImGuiGraphNode_Vector<ImU32> node_colors;
+    ImGuiGraphNode_Vector<ImU32> node_fillcolors;
+    ImGuiGraphNode_Vector<ImGuiID> edge_ids;
+    ImGuiGraphNode_Vector<ImGuiID> edge_tails;
+    ImGuiGraphNode_Vector<ImGuiID> edge_heads;
+    ImGuiGraphNode_Vector<int> edge_labels; // offsets in strings
+    ImGuiGraphNode_Vector<ImVec2> edge_label_pos;
+    ImGuiGraphNode_Vector<ImU32> edge_colors;
+    ImGuiGraphNode_Vector<int> edge_points; // offsets in points, one more than edges once there are edges
+    ImGuiGraphNode_Vector<ImVec2> points;
+    ImGuiGraphNode_StringPool strings;
     ImVec2 size;
     float scale;
+
+    ImGuiGraphNode_Graph() : size(), scale(0.f) {}
+    void Clear();
+    void CreateArena();
+    void Reserve(size_t node_count, size_t edge_count, size_t string_size);
+    int AddString(char const * begin, char const * end) { CreateArena(); return strings.Add(begin, end); }
+    int AddString(char const * str) { CreateArena(); return strings.Add(str); }
+    int GetNodeCount() const { return (int)node_ids.size(); }
+    int GetEdgeCount() const { return (int)edge_ids.size(); }
+    void AddNode(ImGuiID id, int label, ImVec2 const & pos, ImVec2 const & size, ImU32 color, ImU32 fillcolor);
+    void AddEdge(ImGuiID id, ImGuiID tail, ImGuiID head, int label, ImU32 color); // without points
+    ImVec2 * AddEdgePoints(int count); // appended to the last edge
+    void PopEdge();
+    ImVec2 const * GetEdgePoints(int edge) const { return points.data() + edge_points[edge]; }
+    int GetEdgePointCount(int edge) const { return edge_points[edge + 1] - edge_points[edge]; }
+    char const * GetString(int offset) const { return strings.Get(offset); }
+};
+
+struct ImGuiGraphNode_SubmittedNode
+{
+    ImGuiID id;
+    int label; // offset in ImGuiGraphNode_Submission::strings
+    ImU32 color;
+    ImU32 fillcolor;
+};
+
+struct ImGuiGraphNode_SubmittedEdge
+{
+    ImGuiID id;
+    ImGuiID name;
+    ImGuiID tail;
+    ImGuiID head;
+    int label; // offset in ImGuiGraphNode_Submission::strings
+    ImU32 color;
+};
+
+// Snapshot of the nodes and edges submitted between BeginNodeGraph() and
+// EndNodeGraph(). It doesn't depend on ImGui nor graphviz state, so a layout
+// can be computed from it on any thread.
+struct ImGuiGraphNode_Submission
+{
+    ImGuiGraphNodeLayout layout = ImGuiGraphNodeLayout_Dot;
+    ImGuiGraphNode_Vector<ImGuiGraphNode_SubmittedNode> nodes;
+    ImGuiGraphNode_Vector<ImGuiGraphNode_SubmittedEdge> edges;
+    ImGuiGraphNode_Vector<char> strings;
+
+    void Clear();
+    void Reset(ImGuiGraphNode_Arena * arena);
+    int AddString(char const * begin, char const * end);
+    char const * GetString(int offset) const { return strings.data() + offset; }
+};
+
+// Retained graph, the submission is kept across frames and only modified
+// through the Graph* functions. Every modification bumps the generation,
+// which is what triggers a new layout when the graph is drawn.
+struct ImGuiGraphNodeGraph
+{
+    ImGuiGraphNode_Submission submission;
+    std::map<ImGuiID, int> nodeIndices;
+    std::map<std::tuple<ImGuiID, ImGuiID, ImGuiID>, int> edgeIndices; // (name, tail, head)
+    ImU64 uid = 0; // unique across all graphs ever created, unlike the address
+    unsigned int generation = 1;
+    unsigned int layout_generation = 0;
+    size_t garbage = 0; // bytes of submission.strings no longer referenced
+};
+
+// Initial node positions given to graphviz, in inches like
+// ImGuiGraphNode_Graph::node_pos
+struct ImGuiGraphNode_LayoutSeed
+{
+    ImGuiGraphNode_Vector<std::pair<ImGuiID, ImVec2>> positions; // sorted by id
+    bool pinned = false;
+};
+
+struct ImGuiGraphNode_LayoutJob
+{
+    ImGuiGraphNode_Submission submission;
+    ImGuiGraphNode_LayoutSeed seed;
+    bool seeded = false; // seed is only used when the job was queued with one
+    ImGuiGraphNode_Graph graph;
+    std::atomic<bool> cancelled { false };
+    std::atomic<bool> done { false };
+};
+
+// Incremental reader for graphviz "plain" output. Data can be fed in chunks
+// of any size, memory usage is bounded by the longest line.
+struct ImGuiGraphNode_PlainReader
+{
+    ImGuiGraphNode_Graph & graph;
+    ImGuiGraphNode_Vector<std::pair<ImGuiID, ImGuiGraphNode_EdgeInfo>> edgeIdToInfo; // sorted by ImGuiID
+    ImGuiGraphNode_Vector<char> line;
+    char const * error = nullptr;
+    bool stopped = false;
+
+    ImGuiGraphNode_PlainReader(ImGuiGraphNode_Graph & out, ImGuiGraphNode_Submission const & submission);
+    bool Feed(char const * data, size_t size);
+    bool Finish();
+    void ParseLine(char * str);
+};
+
+// Unit circle sampled at each outline level of detail, by increasing point
+// count: level l has IMGUI_GRAPHNODE_DRAW_NODE_PATH_MIN_COUNT << l points.
+struct ImGuiGraphNode_EllipseTable
+{
+    ImVec2 points[IMGUI_GRAPHNODE_DRAW_NODE_PATH_COUNT * 2];
+
+    ImVec2 const * GetPoints(int count) const { return points + count - IMGUI_GRAPHNODE_DRAW_NODE_PATH_MIN_COUNT; }
 };
 
 struct ImGuiGraphNode_DrawNode
 {
-    ImVec2 path[IMGUI_GRAPHNODE_DRAW_NODE_PATH_COUNT];
+    int path_offset; // in ImGuiGraphNodeContextCache::drawpoints
+    int path_count;
+    ImRect bb; // outline and text, used for culling
     ImVec2 textpos;
     char const * text;
     ImU32 color;
@@ -80,7 +380,9 @@ struct ImGuiGraphNode_DrawNode
 
 struct ImGuiGraphNode_DrawEdge
 {
-    ImVec2 path[IMGUI_GRAPHNODE_DRAW_EDGE_PATH_COUNT];
+    int path_offset; // in ImGuiGraphNodeContextCache::drawpoints
+    int path_count;
+    ImRect bb; // path, arrow and text, used for culling
     ImVec2 arrow1;
     ImVec2 arrow2;
     ImVec2 arrow3;
@@ -89,36 +391,160 @@ struct ImGuiGraphNode_DrawEdge
     ImU32 color;
 };
 
+struct ImGuiGraphNode_HitItem
+{
+    ImGuiGraphNode_EdgeRectangle rect; // edge segment, unused for nodes
+    ImRect bb;
+    ImGuiID id;
+    bool node;
+};
+
+// Uniform grid over the hoverable shapes of a graph, in the same space as
+// the draw buffers. Items overlapping several cells are listed in each.
+struct ImGuiGraphNode_HitGrid
+{
+    ImGuiGraphNode_NoInitVector<ImGuiGraphNode_HitItem> items;
+    ImGuiGraphNode_Vector<int> cells; // first index in cellitems for each cell, plus one past the end
+    ImGuiGraphNode_Vector<int> cellitems;
+    ImVec2 origin;
+    float cellsize = 1.f;
+    int width = 0;
+    int height = 0;
+
+    void Clear();
+    void Build();
+    ImGuiGraphNode_HitItem const * Query(ImVec2 const & p) const;
+};
+
+// Barnes-Hut quadtree cell, children are stored contiguously from child
+struct ImGuiGraphNode_QuadCell
+{
+    float cx; // center of mass
+    float cy;
+    float mass;
+    float size;
+    int child; // -1 for leaves
+    int begin; // bodies in ImGuiGraphNode_ForceLayout::order
+    int end;
+};
+
+// Interaction lists of one worker thread, kept across steps
+struct ImGuiGraphNode_ForceScratch
+{
+    ImGuiGraphNode_Vector<float> ix;
+    ImGuiGraphNode_Vector<float> iy;
+    ImGuiGraphNode_Vector<float> im;
+    ImGuiGraphNode_Vector<int> stack;
+};
+
+// Native force directed layout (spring-electrical model), stepped until it
+// converges. Node data is kept in separate arrays, in inches.
+struct ImGuiGraphNode_ForceLayout
+{
+    ImGuiGraphNode_Vector<float> posx;
+    ImGuiGraphNode_Vector<float> posy;
+    ImGuiGraphNode_Vector<float> forcex;
+    ImGuiGraphNode_Vector<float> forcey;
+    ImGuiGraphNode_Vector<float> mobility; // 0 for pinned nodes, 1 otherwise
+    ImGuiGraphNode_Vector<float> width;
+    ImGuiGraphNode_Vector<float> height;
+    ImGuiGraphNode_Vector<int> adjacency_offsets; // neighbors of node i are adjacency[adjacency_offsets[i], adjacency_offsets[i + 1])
+    ImGuiGraphNode_Vector<int> adjacency;
+    ImGuiGraphNode_Vector<int> nodes; // index in the submission of each laid out node
+    ImGuiGraphNode_Vector<int> edges; // index in the submission of each laid out edge
+    ImGuiGraphNode_Vector<int> edgetail;
+    ImGuiGraphNode_Vector<int> edgehead;
+    ImGuiGraphNode_Vector<ImGuiGraphNode_QuadCell> cells;
+    ImGuiGraphNode_Vector<int> leaves; // non empty leaf cells, in tree order
+    ImGuiGraphNode_Vector<int> order; // node indices sorted by quadtree cell
+    ImGuiGraphNode_Vector<float> sortedx; // positions in that order
+    ImGuiGraphNode_Vector<float> sortedy;
+    ImGuiGraphNode_Vector<ImGuiGraphNode_ForceScratch> scratch; // one per thread
+    ImGuiGraphNode_Vector<float> thread_energy;
+    float k = 1.f; // natural edge length
+    float step = 0.f;
+    float energy = 0.f;
+    int progress = 0;
+    int iteration = 0;
+    bool converged = false;
+
+    void Init(ImGuiGraphNode_Submission const & submission, ImGuiGraphNode_LayoutSeed const * seed);
+    bool Step(int iterations, int num_threads);
+    void Write(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission) const;
+};
+
 struct ImGuiGraphNodeContextCache
 {
-    std::map<ImGuiID, ImGuiGraphNode_EdgeInfo> edgeIdToInfo;
+    ImGuiGraphNode_Submission submission;
+    std::shared_ptr<ImGuiGraphNode_LayoutJob> job;
+    std::unique_ptr<ImGuiGraphNode_ForceLayout> progressive; // ImGuiGraphNodeFlags_ProgressiveLayout, released once converged
     ImGuiGraphNode_Graph graph;
-    ImGuiGraphNodeLayout layout = ImGuiGraphNodeLayout_Dot;
+    ImGuiGraphNodeFlags flags = ImGuiGraphNodeFlags_None;
     float pixel_per_unit = 100.f;
-    std::vector<ImGuiGraphNode_DrawNode> drawnodes;
-    std::vector<ImGuiGraphNode_DrawEdge> drawedges;
-    ImVec2 cursor_previous;
-    ImVec2 cursor_current;
-    std::string graphid_previous;
-    std::string graphid_current;
+    ImGuiGraphNode_Vector<ImGuiGraphNode_DrawNode> drawnodes;
+    ImGuiGraphNode_Vector<ImGuiGraphNode_DrawEdge> drawedges;
+    ImGuiGraphNode_NoInitVector<ImVec2> drawpoints;
+    ImGuiGraphNode_HitGrid hitgrid;
+    ImGuiID hovered_id = 0; // resolved once per frame from hitgrid
+    ImRect hovered_bb; // screen space
+    float drawppu = 0.f;
+    ImVec2 cursor; // screen position of the graph
+    int last_frame = 0; // last frame the graph was submitted
+    size_t memory_usage = 0; // refreshed every submission, see ImGuiGraphNode_GetCacheMemoryUsage
+    bool drawdirty = true;
+    ImGuiGraphNode_Vector<ImVec2> textsizes; // labels of the nodes then of the edges of graph
+    ImFont const * textsizes_font = nullptr;
+    float textsizes_font_size = 0.f;
+    bool textsizes_dirty = true; // labels changed since textsizes was measured
+    ImU64 graphid_previous = 0;
+    ImU64 graphid_current = 0;
+#ifdef IMGUI_GRAPHNODE_DEBUG_GRAPHID
+    // Full keys hashed into graphid_*, only kept to detect hash collisions
+    std::string graphkey_previous;
+    std::string graphkey_current;
+#endif /* IMGUI_GRAPHNODE_DEBUG_GRAPHID */
 };
 
 struct ImGuiGraphNodeContext
 {
     GVC_t * gvcontext = nullptr;
-    graph_t * gvgraph = nullptr;
     ImGuiID lastid = 0;
     std::map<ImGuiID, ImGuiGraphNodeContextCache> graph_caches;
+    ImGuiGraphNode_Arena frame_arena; // submissions of the current frame, reset on the next one
+    size_t frame_allocations_start = 0; // heap allocation count when the current frame started
+    size_t frame_allocations = 0; // heap allocations during the last complete frame
+    int cache_max_unused_frames = 3600; // 0 to keep unused caches
+    size_t cache_max_bytes = 0; // 0 for no budget
+    int cache_gc_frame = -1;
+    float progressive_budget = 2.f; // milliseconds per graph and frame
+    int draw_threads = 1; // threads filling edge draw buffers, 0 for one per core
+    std::mutex diskcache_mutex; // guards diskcache_directory, read by layout threads
+    std::string diskcache_directory; // empty when the disk cache is disabled
+    std::atomic<int> diskcache_hits { 0 };
+    std::atomic<int> diskcache_misses { 0 };
+    std::thread worker;
+    std::mutex worker_mutex;
+    std::condition_variable worker_cv;
+    std::deque<std::shared_ptr<ImGuiGraphNode_LayoutJob>> worker_queue;
+    bool worker_quit = false;
 };
 
-extern ImGuiGraphNodeContext g_ctx;
+// Current context, define GImGuiGraphNode to a thread local variable to give
+// each thread its own context, like GImGui.
+#ifndef GImGuiGraphNode
+extern IMGUI_API ImGuiGraphNodeContext * GImGuiGraphNode;
+#endif /* GImGuiGraphNode */
+
+extern IMGUI_API ImGuiGraphNode_AllocationCounters GImGuiGraphNodeAllocations;
 
 template <size_t N>
 class ImGuiGraphNode_ShortString
 {
 public:
     friend ImGuiGraphNode_ShortString<32> ImGuiIDToString(char const * id);
+    friend ImGuiGraphNode_ShortString<32> ImGuiIDToString(ImGuiID id);
     friend ImGuiGraphNode_ShortString<16> ImVec4ColorToString(ImVec4 const & color);
+    friend ImGuiGraphNode_ShortString<16> ImU32ColorToString(ImU32 color);
 
     operator char *() { return buf; }
     operator char const *() const { return buf; }
@@ -127,16 +553,60 @@ private:
     char buf[N];
 };
 
+// Buffers rebuilt on every layout or refill are cleared rather than freed so
+// their storage is reused, and only trimmed once it is mostly unused.
+template <typename T, typename A>
+void ImGuiGraphNode_TrimVector(std::vector<T, A> & v)
+{
+    if (v.capacity() * sizeof(T) > 4096 && v.capacity() > v.size() * 4)
+        v.shrink_to_fit();
+}
+
 IMGUI_API ImGuiGraphNode_ShortString<32> ImGuiIDToString(char const * id);
+IMGUI_API ImGuiGraphNode_ShortString<32> ImGuiIDToString(ImGuiID id);
 IMGUI_API ImGuiGraphNode_ShortString<16> ImVec4ColorToString(ImVec4 const & color);
+IMGUI_API ImGuiGraphNode_ShortString<16> ImU32ColorToString(ImU32 color);
+IMGUI_API ImU64 ImGuiGraphNode_HashData(void const * data, size_t size, ImU64 seed);
+IMGUI_API void ImGuiGraphNode_HashGraphId(ImGuiGraphNodeContextCache & cache, void const * data, size_t size);
 IMGUI_API ImU32 ImGuiGraphNode_StringToU32Color(char const * color);
 IMGUI_API ImVec4 ImGuiGraphNode_StringToImVec4Color(char const * color);
 IMGUI_API char * ImGuiGraphNode_ReadToken(char ** stringp);
 IMGUI_API char * ImGuiGraphNode_ReadLine(char ** stringp);
-IMGUI_API bool ImGuiGraphNode_ReadGraphFromMemory(ImGuiGraphNodeContextCache & cache, char const * data, size_t size);
+IMGUI_API bool ImGuiGraphNode_ParseInt(char const * str, int * out);
+IMGUI_API bool ImGuiGraphNode_ParseFloat(char const * str, float * out);
+IMGUI_API bool ImGuiGraphNode_ReadGraphFromMemory(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission, char const * data, size_t size, char const ** error = nullptr);
+#ifndef IMGUI_GRAPHNODE_NO_GRAPHVIZ
+IMGUI_API void ImGuiGraphNode_ReadGraphFromLayout(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission, graph_t * gvgraph, Agnode_t * const * gvnodes, Agedge_t * const * gvedges);
+#endif /* !IMGUI_GRAPHNODE_NO_GRAPHVIZ */
 IMGUI_API char const * ImGuiGraphNode_GetEngineNameFromLayoutEnum(ImGuiGraphNodeLayout layout);
-IMGUI_API ImVec2 ImGuiGraphNode_BezierVec2(ImVec2 const * points, int count, float x);
-IMGUI_API ImVec2 ImGuiGraphNode_BSplineVec2(ImVec2 const * points, int count, float x);
-IMGUI_API void ImGuiGraphNodeRenderGraphLayout(ImGuiGraphNodeContextCache & cache);
+IMGUI_API int ImGuiGraphNode_CountSplineSamples(ImVec2 const * points, int count, float scale, float tol);
+IMGUI_API void ImGuiGraphNode_TessellateSplineAdaptive(ImVec2 const * points, int count, ImVec2 scale, ImVec2 offset, float tol, ImVec2 * out);
+IMGUI_API void ImGuiGraphNode_TessellateCubic(ImVec2 const * p, int n, ImVec2 * out);
+IMGUI_API ImRect ImGuiGraphNode_CalcBounds(ImVec2 const * points, int count);
+IMGUI_API ImGuiGraphNode_EllipseTable const & ImGuiGraphNode_GetEllipseTable();
+IMGUI_API void ImGuiGraphNode_CalcEllipseLodRadii(float max_error, float * radii);
+IMGUI_API void ImGuiGraphNode_TransformPoints(ImVec2 const * points, int count, ImVec2 center, ImVec2 scale, ImVec2 * out);
+IMGUI_API std::mutex & ImGuiGraphNode_GetGraphvizMutex();
+IMGUI_API GVC_t * ImGuiGraphNode_CreateGraphvizContext();
+IMGUI_API void ImGuiGraphNode_FreeGraphvizContext(GVC_t * gvcontext);
+IMGUI_API int ImGuiGraphNodeFillDrawNodeBuffer(ImGuiGraphNode_Graph const & graph, ImVec2 const * textsizes, ImGuiGraphNode_DrawNode * drawnodes, ImGuiGraphNode_NoInitVector<ImVec2> & drawpoints, ImGuiGraphNode_HitGrid & hitgrid, float ppu);
+IMGUI_API int ImGuiGraphNodeFillDrawEdgeBuffer(ImGuiGraphNode_Graph const & graph, ImVec2 const * textsizes, ImGuiGraphNode_DrawEdge * drawedges, ImGuiGraphNode_NoInitVector<ImVec2> & drawpoints, ImGuiGraphNode_HitGrid & hitgrid, float ppu, int num_threads = 1);
+IMGUI_API size_t ImGuiGraphNode_GetCacheMemoryUsage(ImGuiGraphNodeContextCache const & cache);
+IMGUI_API void ImGuiGraphNodeCollectCaches(ImGuiGraphNodeContext & ctx, int frame);
+IMGUI_API bool ImGuiGraphNode_FillLayoutSeed(ImGuiGraphNode_LayoutSeed & seed, ImGuiGraphNode_Graph const & graph, ImGuiGraphNodeLayout layout, ImGuiGraphNodeFlags flags);
+IMGUI_API void ImGuiGraphNodeRenderGraphLayout(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission, GVC_t * gvcontext, ImGuiGraphNode_LayoutSeed const * seed = nullptr);
+IMGUI_API void ImGuiGraphNodeRenderForceDirectedLayout(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission, ImGuiGraphNode_LayoutSeed const * seed = nullptr);
+IMGUI_API bool ImGuiGraphNodeRenderTreeLayout(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission);
+IMGUI_API void ImGuiGraphNodeRenderLayeredLayout(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission);
+IMGUI_API ImU64 ImGuiGraphNode_HashSubmission(ImGuiGraphNode_Submission const & submission);
+IMGUI_API void ImGuiGraphNode_WriteGraphToCache(ImGuiGraphNode_Graph const & graph, ImU64 key, ImGuiGraphNode_Vector<char> & out);
+IMGUI_API bool ImGuiGraphNode_ReadGraphFromCache(ImGuiGraphNode_Graph & graph, ImU64 key, void const * data, size_t size);
+IMGUI_API bool ImGuiGraphNode_LoadGraphCacheFile(ImGuiGraphNode_Graph & graph, ImU64 key, char const * path);
+IMGUI_API bool ImGuiGraphNode_SaveGraphCacheFile(ImGuiGraphNode_Graph const & graph, ImU64 key, char const * path);
+IMGUI_API void ImGuiGraphNodeComputeGraphLayout(ImGuiGraphNodeContext & ctx, ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission, GVC_t * gvcontext, ImGuiGraphNode_LayoutSeed const * seed = nullptr);
+IMGUI_API void ImGuiGraphNodeRenderGraphLayouts(ImGuiGraphNodeContext & ctx, ImGuiGraphNode_Graph * graphs, ImGuiGraphNode_Submission const * submissions, int count, int num_threads);
+IMGUI_API void ImGuiGraphNodeStartLayoutWorker(ImGuiGraphNodeContext & ctx);
+IMGUI_API void ImGuiGraphNodeStopLayoutWorker(ImGuiGraphNodeContext & ctx);
+IMGUI_API void ImGuiGraphNodeQueueLayoutJob(ImGuiGraphNodeContext & ctx, ImGuiGraphNodeContextCache & cache, ImGuiGraphNode_Submission const & submission, ImGuiGraphNode_LayoutSeed const * seed = nullptr);
 
 #endif /* !IMGUI_GRAPHNODE_INTERNAL_H_ */
@@ -0,0 +1,1515 @@
+#include "imgui_graphnode.h"
+#include "imgui_graphnode_internal.h"
+#include "imgui_internal.h"
+
+#include <climits>
+
+// Native force directed layout, after Hu's spring-electrical model (the one
+// sfdp is based on): nodes repel each other with a force in K^2/d, computed
+// with a Barnes-Hut quadtree, and edges pull their ends with a force in d^2/K.
+// Positions move along the total force by a step adapted between iterations.
+
+#define IMGUI_GRAPHNODE_FORCE_REPULSION 0.2f
+#define IMGUI_GRAPHNODE_FORCE_THETA 1.0f
+#define IMGUI_GRAPHNODE_FORCE_COOLING 0.9f
+#define IMGUI_GRAPHNODE_FORCE_TOLERANCE 0.005f
+#define IMGUI_GRAPHNODE_FORCE_MAX_ITERATIONS 1000
+#define IMGUI_GRAPHNODE_FORCE_LEAF_SIZE 8
+#define IMGUI_GRAPHNODE_FORCE_MAX_DEPTH 24
+#define IMGUI_GRAPHNODE_FORCE_NODES_PER_THREAD 1024
+
+// Default graphviz node: 14pt font in an ellipse fitting the text box scaled
+// by sqrt(2), at least 0.75 x 0.5 inches.
+static void ImGuiGraphNode_EstimateNodeSize(char const * label, float * width, float * height)
+{
+    float const char_width = 14.f * 0.55f / 72.f;
+    float const line_height = 14.f * 1.2f / 72.f;
+    int lines = 1;
+    int longest = 0;
+    int current = 0;
+
+    for (char const * c = label; *c; ++c)
+    {
+        if (*c == '\n')
+        {
+            ++lines;
+            current = 0;
+        }
+        else
+        {
+            longest = ImMax(longest, ++current);
+        }
+    }
+    *width = ImMax(0.75f, (longest * char_width + 0.22f) * 1.4142f);
+    *height = ImMax(0.5f, (lines * line_height + 0.11f) * 1.4142f);
+}
+
+static float ImGuiGraphNode_HashToUnit(ImGuiID id, int shift)
+{
+    ImU64 const hash = ImGuiGraphNode_HashData(&id, sizeof(id), 0);
+    return (float)((hash >> shift) & 0xffff) / 65535.f;
+}
+
+// Nodes and edges submitted more than once are only laid out once, like
+// with graphviz. Elements are given as indices in the submission, in
+// submission order, edge ends as indices in nodes. Edges to unknown nodes
+// are dropped.
+static void ImGuiGraphNode_CollectElements(ImGuiGraphNode_Submission const & submission, ImGuiGraphNode_Vector<int> & nodes, ImGuiGraphNode_Vector<int> & edges, ImGuiGraphNode_Vector<int> & edgetail, ImGuiGraphNode_Vector<int> & edgehead)
+{
+    ImGuiGraphNode_Vector<std::pair<ImGuiID, int>> ids;
+
+    ids.reserve(submission.nodes.size());
+    for (int i = 0; i < (int)submission.nodes.size(); ++i)
+        ids.push_back(std::make_pair(submission.nodes[i].id, i));
+    std::stable_sort(ids.begin(), ids.end(), [](std::pair<ImGuiID, int> const & a, std::pair<ImGuiID, int> const & b) { return a.first < b.first; });
+    ids.erase(std::unique(ids.begin(), ids.end(), [](std::pair<ImGuiID, int> const & a, std::pair<ImGuiID, int> const & b) { return a.first == b.first; }), ids.end());
+    nodes.clear();
+    for (auto const & id : ids)
+        nodes.push_back(id.second);
+    std::sort(nodes.begin(), nodes.end());
+    for (int i = 0; i < (int)nodes.size(); ++i)
+        ids[i] = std::make_pair(submission.nodes[nodes[i]].id, i);
+    std::sort(ids.begin(), ids.end());
+
+    auto const find_node = [&ids](ImGuiID id) -> int
+    {
+        auto const it = std::lower_bound(ids.begin(), ids.end(), std::make_pair(id, 0));
+        return it != ids.end() && it->first == id ? it->second : -1;
+    };
+
+    ImGuiGraphNode_Vector<std::tuple<ImGuiID, ImGuiID, ImGuiID, int>> keys;
+
+    keys.reserve(submission.edges.size());
+    for (int i = 0; i < (int)submission.edges.size(); ++i)
+    {
+        ImGuiGraphNode_SubmittedEdge const & edge = submission.edges[i];
+        keys.push_back(std::make_tuple(edge.name, edge.tail, edge.head, i));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end(), [](std::tuple<ImGuiID, ImGuiID, ImGuiID, int> const & a, std::tuple<ImGuiID, ImGuiID, ImGuiID, int> const & b)
+    {
+        return std::get<0>(a) == std::get<0>(b) && std::get<1>(a) == std::get<1>(b) && std::get<2>(a) == std::get<2>(b);
+    }), keys.end());
+    edges.clear();
+    for (auto const & key : keys)
+        edges.push_back(std::get<3>(key));
+    std::sort(edges.begin(), edges.end());
+
+    // Edges to unknown nodes are dropped, the others are compacted in place
+    int count = 0;
+
+    edgetail.clear();
+    edgehead.clear();
+    edgetail.reserve(edges.size());
+    edgehead.reserve(edges.size());
+    for (int i = 0; i < (int)edges.size(); ++i)
+    {
+        int const tail = find_node(submission.edges[edges[i]].tail);
+        int const head = find_node(submission.edges[edges[i]].head);
+
+        if (tail < 0 || head < 0)
+            continue;
+        edges[count++] = edges[i];
+        edgetail.push_back(tail);
+        edgehead.push_back(head);
+    }
+    edges.resize(count);
+}
+
+void ImGuiGraphNode_ForceLayout::Init(ImGuiGraphNode_Submission const & submission, ImGuiGraphNode_LayoutSeed const * seed)
+{
+    ImGuiGraphNode_CollectElements(submission, nodes, edges, edgetail, edgehead);
+
+    int const count = (int)nodes.size();
+
+    adjacency_offsets.assign(count + 1, 0);
+    for (int i = 0; i < (int)edges.size(); ++i)
+    {
+        if (edgetail[i] != edgehead[i])
+        {
+            ++adjacency_offsets[edgetail[i] + 1];
+            ++adjacency_offsets[edgehead[i] + 1];
+        }
+    }
+    for (int i = 0; i < count; ++i)
+        adjacency_offsets[i + 1] += adjacency_offsets[i];
+    adjacency.resize(adjacency_offsets[count]);
+    {
+        ImGuiGraphNode_Vector<int> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+
+        for (int i = 0; i < (int)edges.size(); ++i)
+        {
+            if (edgetail[i] == edgehead[i])
+                continue;
+            adjacency[fill[edgetail[i]]++] = edgehead[i];
+            adjacency[fill[edgehead[i]]++] = edgetail[i];
+        }
+    }
+
+    width.resize(count);
+    height.resize(count);
+    posx.resize(count);
+    posy.resize(count);
+    forcex.assign(count, 0.f);
+    forcey.assign(count, 0.f);
+    mobility.assign(count, 1.f);
+
+    float total_width = 0.f;
+
+    for (int i = 0; i < count; ++i)
+    {
+        ImGuiGraphNode_EstimateNodeSize(submission.GetString(submission.nodes[nodes[i]].label), &width[i], &height[i]);
+        total_width += width[i];
+    }
+    k = (count ? total_width / count : 0.75f) + 0.5f;
+
+    // Seeded nodes start where they were, others next to their seeded
+    // neighbors when they have some, anywhere otherwise
+    ImGuiGraphNode_Vector<bool> placed(count, false);
+    int seeded = 0;
+    float const side = ImSqrt((float)ImMax(count, 1)) * k;
+
+    for (int i = 0; i < count; ++i)
+    {
+        ImGuiID const id = submission.nodes[nodes[i]].id;
+
+        if (seed)
+        {
+            auto const it = std::lower_bound(seed->positions.begin(), seed->positions.end(), id, [](std::pair<ImGuiID, ImVec2> const & a, ImGuiID b) { return a.first < b; });
+
+            if (it != seed->positions.end() && it->first == id)
+            {
+                posx[i] = it->second.x;
+                posy[i] = it->second.y;
+                mobility[i] = seed->pinned ? 0.f : 1.f;
+                placed[i] = true;
+                ++seeded;
+                continue;
+            }
+        }
+        posx[i] = ImGuiGraphNode_HashToUnit(id, 0) * side;
+        posy[i] = ImGuiGraphNode_HashToUnit(id, 16) * side;
+    }
+    if (seeded)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (placed[i])
+                continue;
+
+            float x = 0.f;
+            float y = 0.f;
+            int n = 0;
+
+            for (int a = adjacency_offsets[i]; a < adjacency_offsets[i + 1]; ++a)
+            {
+                if (placed[adjacency[a]])
+                {
+                    x += posx[adjacency[a]];
+                    y += posy[adjacency[a]];
+                    ++n;
+                }
+            }
+            if (n)
+            {
+                ImGuiID const id = submission.nodes[nodes[i]].id;
+
+                posx[i] = x / n + (ImGuiGraphNode_HashToUnit(id, 0) - 0.5f) * k;
+                posy[i] = y / n + (ImGuiGraphNode_HashToUnit(id, 16) - 0.5f) * k;
+            }
+        }
+    }
+
+    // A seeded layout is mostly settled already, only refine it
+    step = seeded ? k * 0.5f : ImMax(k, side * 0.1f);
+    energy = FLT_MAX;
+    progress = 0;
+    iteration = 0;
+    converged = count < 2;
+}
+
+static void ImGuiGraphNode_BuildQuadCell(ImGuiGraphNode_ForceLayout & layout, int cell, float x0, float y0, float size, int begin, int end, int depth)
+{
+    int * const order = layout.order.data();
+    float cx = 0.f;
+    float cy = 0.f;
+
+    for (int i = begin; i < end; ++i)
+    {
+        cx += layout.posx[order[i]];
+        cy += layout.posy[order[i]];
+    }
+
+    ImGuiGraphNode_QuadCell & c = layout.cells[cell];
+
+    c.mass = (float)(end - begin);
+    c.cx = end > begin ? cx / c.mass : 0.f;
+    c.cy = end > begin ? cy / c.mass : 0.f;
+    c.size = size;
+    c.child = -1;
+    c.begin = begin;
+    c.end = end;
+    if (end - begin <= IMGUI_GRAPHNODE_FORCE_LEAF_SIZE || depth >= IMGUI_GRAPHNODE_FORCE_MAX_DEPTH)
+    {
+        if (end > begin)
+            layout.leaves.push_back(cell);
+        return;
+    }
+
+    float const half = size * 0.5f;
+    float const mx = x0 + half;
+    float const my = y0 + half;
+    float const * const posx = layout.posx.data();
+    float const * const posy = layout.posy.data();
+    int * const mid = std::partition(order + begin, order + end, [posy, my](int i) { return posy[i] < my; });
+    int * const q1 = std::partition(order + begin, mid, [posx, mx](int i) { return posx[i] < mx; });
+    int * const q3 = std::partition(mid, order + end, [posx, mx](int i) { return posx[i] < mx; });
+    int const child = (int)layout.cells.size();
+
+    // Growing cells invalidates c
+    layout.cells.resize(child + 4);
+    layout.cells[cell].child = child;
+    ImGuiGraphNode_BuildQuadCell(layout, child + 0, x0, y0, half, begin, (int)(q1 - order), depth + 1);
+    ImGuiGraphNode_BuildQuadCell(layout, child + 1, mx, y0, half, (int)(q1 - order), (int)(mid - order), depth + 1);
+    ImGuiGraphNode_BuildQuadCell(layout, child + 2, x0, my, half, (int)(mid - order), (int)(q3 - order), depth + 1);
+    ImGuiGraphNode_BuildQuadCell(layout, child + 3, mx, my, half, (int)(q3 - order), end, depth + 1);
+}
+
+// Sum of the repulsions from count point masses on a body at (px, py)
+static void ImGuiGraphNode_AccumulateRepulsion(float px, float py, float const * x, float const * y, float const * m, int count, float ck2, float eps, float * out_fx, float * out_fy)
+{
+    float fx = 0.f;
+    float fy = 0.f;
+    int i = 0;
+
+#ifdef IMGUI_ENABLE_SSE
+    __m128 const vpx = _mm_set1_ps(px);
+    __m128 const vpy = _mm_set1_ps(py);
+    __m128 const vck2 = _mm_set1_ps(ck2);
+    __m128 const veps = _mm_set1_ps(eps);
+    __m128 const vtwo = _mm_set1_ps(2.f);
+    __m128 vfx = _mm_setzero_ps();
+    __m128 vfy = _mm_setzero_ps();
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 const dx = _mm_sub_ps(vpx, _mm_loadu_ps(x + i));
+        __m128 const dy = _mm_sub_ps(vpy, _mm_loadu_ps(y + i));
+        __m128 const d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), veps);
+        // Reciprocal estimate refined by one Newton-Raphson step, plenty for
+        // a layout and much cheaper than a division
+        __m128 r = _mm_rcp_ps(d2);
+        r = _mm_mul_ps(r, _mm_sub_ps(vtwo, _mm_mul_ps(d2, r)));
+        __m128 const f = _mm_mul_ps(_mm_mul_ps(vck2, _mm_loadu_ps(m + i)), r);
+
+        vfx = _mm_add_ps(vfx, _mm_mul_ps(dx, f));
+        vfy = _mm_add_ps(vfy, _mm_mul_ps(dy, f));
+    }
+
+    float sx[4];
+    float sy[4];
+
+    _mm_storeu_ps(sx, vfx);
+    _mm_storeu_ps(sy, vfy);
+    fx = (sx[0] + sx[1]) + (sx[2] + sx[3]);
+    fy = (sy[0] + sy[1]) + (sy[2] + sy[3]);
+#endif /* IMGUI_ENABLE_SSE */
+    for (; i < count; ++i)
+    {
+        float const dx = px - x[i];
+        float const dy = py - y[i];
+        float const f = ck2 * m[i] / (dx * dx + dy * dy + eps);
+
+        fx += dx * f;
+        fy += dy * f;
+    }
+    *out_fx = fx;
+    *out_fy = fy;
+}
+
+bool ImGuiGraphNode_ForceLayout::Step(int iterations, int num_threads)
+{
+    int const count = (int)posx.size();
+
+    if (num_threads <= 0)
+        num_threads = ImMax((int)std::thread::hardware_concurrency(), 1);
+    for (int it = 0; it < iterations && !converged; ++it)
+    {
+        // Quadtree over the current positions
+        float minx = FLT_MAX;
+        float miny = FLT_MAX;
+        float maxx = -FLT_MAX;
+        float maxy = -FLT_MAX;
+
+        for (int i = 0; i < count; ++i)
+        {
+            minx = ImMin(minx, posx[i]);
+            miny = ImMin(miny, posy[i]);
+            maxx = ImMax(maxx, posx[i]);
+            maxy = ImMax(maxy, posy[i]);
+        }
+        order.resize(count);
+        for (int i = 0; i < count; ++i)
+            order[i] = i;
+        cells.clear();
+        cells.resize(1);
+        leaves.clear();
+        ImGuiGraphNode_BuildQuadCell(*this, 0, minx, miny, ImMax(ImMax(maxx - minx, maxy - miny), 1e-3f), 0, count, 0);
+        sortedx.resize(count);
+        sortedy.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            sortedx[i] = posx[order[i]];
+            sortedy[i] = posy[order[i]];
+        }
+
+        // Forces. The tree is walked once per leaf, and the resulting point
+        // masses are shared by all the bodies of the leaf: cells are opened
+        // based on their distance to the leaf's bounding box rather than to
+        // each body. The leaf's own bodies are part of the list, a body's
+        // repulsion on itself is zero.
+        float const ck2 = IMGUI_GRAPHNODE_FORCE_REPULSION * k * k;
+        float const eps = 1e-4f * k * k;
+        float const theta2 = IMGUI_GRAPHNODE_FORCE_THETA * IMGUI_GRAPHNODE_FORCE_THETA;
+        if ((int)scratch.size() < num_threads)
+            scratch.resize(num_threads);
+        thread_energy.assign(num_threads, 0.f);
+
+        ImGuiGraphNode_ParallelFor((int)leaves.size(), num_threads, [&](int begin, int end, int thread)
+        {
+            ImGuiGraphNode_Vector<float> & ix = scratch[thread].ix;
+            ImGuiGraphNode_Vector<float> & iy = scratch[thread].iy;
+            ImGuiGraphNode_Vector<float> & im = scratch[thread].im;
+            ImGuiGraphNode_Vector<int> & stack = scratch[thread].stack;
+            float e = 0.f;
+
+            for (int l = begin; l < end; ++l)
+            {
+                ImGuiGraphNode_QuadCell const & leaf = cells[leaves[l]];
+                ImRect bb(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+                for (int o = leaf.begin; o < leaf.end; ++o)
+                    bb.Add(ImVec2(sortedx[o], sortedy[o]));
+                ix.clear();
+                iy.clear();
+                im.clear();
+                stack.clear();
+                stack.push_back(0);
+                while (!stack.empty())
+                {
+                    ImGuiGraphNode_QuadCell const & c = cells[stack.back()];
+
+                    stack.pop_back();
+                    if (c.child < 0)
+                    {
+                        ix.insert(ix.end(), sortedx.begin() + c.begin, sortedx.begin() + c.end);
+                        iy.insert(iy.end(), sortedy.begin() + c.begin, sortedy.begin() + c.end);
+                        im.insert(im.end(), c.end - c.begin, 1.f);
+                        continue;
+                    }
+
+                    float const dx = ImMax(ImMax(bb.Min.x - c.cx, c.cx - bb.Max.x), 0.f);
+                    float const dy = ImMax(ImMax(bb.Min.y - c.cy, c.cy - bb.Max.y), 0.f);
+
+                    if (c.size * c.size < theta2 * (dx * dx + dy * dy))
+                    {
+                        ix.push_back(c.cx);
+                        iy.push_back(c.cy);
+                        im.push_back(c.mass);
+                    }
+                    else
+                    {
+                        for (int q = 0; q < 4; ++q)
+                        {
+                            if (cells[c.child + q].mass > 0.f)
+                                stack.push_back(c.child + q);
+                        }
+                    }
+                }
+                for (int o = leaf.begin; o < leaf.end; ++o)
+                {
+                    int const i = order[o];
+                    float const px = sortedx[o];
+                    float const py = sortedy[o];
+                    float fx;
+                    float fy;
+
+                    ImGuiGraphNode_AccumulateRepulsion(px, py, ix.data(), iy.data(), im.data(), (int)ix.size(), ck2, eps, &fx, &fy);
+                    for (int a = adjacency_offsets[i]; a < adjacency_offsets[i + 1]; ++a)
+                    {
+                        int const j = adjacency[a];
+                        float const dx = posx[j] - px;
+                        float const dy = posy[j] - py;
+                        float const d = ImSqrt(dx * dx + dy * dy);
+
+                        fx += dx * d / k;
+                        fy += dy * d / k;
+                    }
+                    forcex[i] = fx;
+                    forcey[i] = fy;
+                    e += (fx * fx + fy * fy) * mobility[i];
+                }
+            }
+            thread_energy[thread] = e;
+        }, IMGUI_GRAPHNODE_FORCE_NODES_PER_THREAD);
+
+        // Adaptive step: grow it back after steady progress, shrink it as
+        // soon as the energy goes up
+        float new_energy = 0.f;
+
+        for (float e : thread_energy)
+            new_energy += e;
+        if (new_energy < energy)
+        {
+            if (++progress >= 5)
+            {
+                progress = 0;
+                step /= IMGUI_GRAPHNODE_FORCE_COOLING;
+            }
+        }
+        else
+        {
+            progress = 0;
+            step *= IMGUI_GRAPHNODE_FORCE_COOLING;
+        }
+        energy = new_energy;
+
+        // Every node moves by step along its force
+        float * const x = posx.data();
+        float * const y = posy.data();
+        float const * const fx = forcex.data();
+        float const * const fy = forcey.data();
+        float const * const mob = mobility.data();
+        int i = 0;
+
+#ifdef IMGUI_ENABLE_SSE
+        __m128 const vstep = _mm_set1_ps(step);
+        __m128 const vtiny = _mm_set1_ps(1e-12f);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 const vfx = _mm_loadu_ps(fx + i);
+            __m128 const vfy = _mm_loadu_ps(fy + i);
+            __m128 const len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vfx, vfx), _mm_mul_ps(vfy, vfy)), vtiny));
+            __m128 const s = _mm_div_ps(_mm_mul_ps(vstep, _mm_loadu_ps(mob + i)), len);
+
+            _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(vfx, s)));
+            _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(vfy, s)));
+        }
+#endif /* IMGUI_ENABLE_SSE */
+        for (; i < count; ++i)
+        {
+            float const s = step * mob[i] / ImSqrt(fx[i] * fx[i] + fy[i] * fy[i] + 1e-12f);
+
+            x[i] += fx[i] * s;
+            y[i] += fy[i] * s;
+        }
+
+        ++iteration;
+        converged = step < k * IMGUI_GRAPHNODE_FORCE_TOLERANCE || iteration >= IMGUI_GRAPHNODE_FORCE_MAX_ITERATIONS;
+    }
+    return converged;
+}
+
+// Point where the segment from the center of an ellipse towards dir leaves it
+static ImVec2 ImGuiGraphNode_EllipseBoundary(ImVec2 const & center, float width, float height, ImVec2 const & dir)
+{
+    float const a = width * 0.5f;
+    float const b = height * 0.5f;
+    float const t = 1.f / ImSqrt((dir.x * dir.x) / (a * a) + (dir.y * dir.y) / (b * b));
+
+    return ImVec2(center.x + dir.x * t, center.y + dir.y * t);
+}
+
+// Points of the last added edge, between the outlines of two nodes through a
+// list of bends, as a chain of straight cubic bezier segments
+static void ImGuiGraphNode_WritePolylineEdge(ImGuiGraphNode_Graph & graph, int tail, int head, ImVec2 const * bends, int bend_count)
+{
+    ImVec2 const tailpos = graph.node_pos[tail];
+    ImVec2 const headpos = graph.node_pos[head];
+    ImVec2 const first = bend_count ? bends[0] : headpos;
+    ImVec2 const last = bend_count ? bends[bend_count - 1] : tailpos;
+    ImVec2 dir0(first.x - tailpos.x, first.y - tailpos.y);
+    ImVec2 dir3(headpos.x - last.x, headpos.y - last.y);
+    float const d0 = ImSqrt(dir0.x * dir0.x + dir0.y * dir0.y);
+    float const d3 = ImSqrt(dir3.x * dir3.x + dir3.y * dir3.y);
+
+    dir0 = d0 > 0.f ? ImVec2(dir0.x / d0, dir0.y / d0) : ImVec2(1.f, 0.f);
+    dir3 = d3 > 0.f ? ImVec2(dir3.x / d3, dir3.y / d3) : ImVec2(1.f, 0.f);
+
+    ImVec2 p0 = ImGuiGraphNode_EllipseBoundary(tailpos, graph.node_sizes[tail].x, graph.node_sizes[tail].y, dir0);
+    ImVec2 p3 = ImGuiGraphNode_EllipseBoundary(headpos, graph.node_sizes[head].x, graph.node_sizes[head].y, ImVec2(-dir3.x, -dir3.y));
+
+    // Overlapping nodes, join the centers
+    if (bend_count == 0 && (p3.x - p0.x) * dir0.x + (p3.y - p0.y) * dir0.y <= 0.f)
+    {
+        p0 = tailpos;
+        p3 = ImVec2(tailpos.x + dir0.x * ImMax(d0, 1e-3f), tailpos.y + dir0.y * ImMax(d0, 1e-3f));
+    }
+
+    ImVec2 * const points = graph.AddEdgePoints(1 + (bend_count + 1) * 3);
+
+    points[0] = p0;
+    for (int i = 0; i <= bend_count; ++i)
+    {
+        ImVec2 const a = i == 0 ? p0 : bends[i - 1];
+        ImVec2 const b = i == bend_count ? p3 : bends[i];
+
+        points[i * 3 + 1] = ImVec2(a.x + (b.x - a.x) / 3.f, a.y + (b.y - a.y) / 3.f);
+        points[i * 3 + 2] = ImVec2(a.x + (b.x - a.x) * 2.f / 3.f, a.y + (b.y - a.y) * 2.f / 3.f);
+        points[i * 3 + 3] = b;
+    }
+
+    int const middle = bend_count / 2;
+
+    graph.edge_label_pos.back() = ImVec2((points[middle * 3].x + points[middle * 3 + 3].x) * 0.5f, (points[middle * 3].y + points[middle * 3 + 3].y) * 0.5f);
+}
+
+// Loops are drawn on the right of their node, up to 1.8 times its half width
+static void ImGuiGraphNode_WriteLoopEdge(ImGuiGraphNode_Graph & graph, int node)
+{
+    ImVec2 const pos = graph.node_pos[node];
+    float const a = graph.node_sizes[node].x * 0.5f;
+    float const b = graph.node_sizes[node].y * 0.5f;
+    ImVec2 * const points = graph.AddEdgePoints(4);
+
+    points[0] = ImVec2(pos.x + a * 0.866f, pos.y + b * 0.5f);
+    points[1] = ImVec2(pos.x + a * 1.8f, pos.y + b * 1.2f);
+    points[2] = ImVec2(pos.x + a * 1.8f, pos.y - b * 1.2f);
+    points[3] = ImVec2(pos.x + a * 0.866f, pos.y - b * 0.5f);
+    graph.edge_label_pos.back() = ImVec2(pos.x + a * 1.8f, pos.y);
+}
+
+// Copies a submitted edge into the graph, its points are written next
+static void ImGuiGraphNode_AddSubmittedEdge(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission, ImGuiGraphNode_SubmittedEdge const & submitted)
+{
+    graph.AddEdge(submitted.id, submitted.tail, submitted.head, graph.AddString(submission.GetString(submitted.label)), submitted.color);
+}
+
+// Same output as a graphviz layout: positions in inches from the bottom left
+// corner, edges as cubic bezier control points
+void ImGuiGraphNode_ForceLayout::Write(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission) const
+{
+    int const count = (int)nodes.size();
+    float minx = FLT_MAX;
+    float miny = FLT_MAX;
+    float maxx = -FLT_MAX;
+    float maxy = -FLT_MAX;
+
+    graph.Clear();
+    graph.scale = 1.f;
+    if (count == 0)
+        return;
+    for (int i = 0; i < count; ++i)
+    {
+        minx = ImMin(minx, posx[i] - width[i] * 0.5f);
+        miny = ImMin(miny, posy[i] - height[i] * 0.5f);
+        maxx = ImMax(maxx, posx[i] + width[i] * 0.5f);
+        maxy = ImMax(maxy, posy[i] + height[i] * 0.5f);
+    }
+
+    // Loops are drawn on the right of their node
+    for (int i = 0; i < (int)edges.size(); ++i)
+    {
+        if (edgetail[i] == edgehead[i])
+            maxx = ImMax(maxx, posx[edgetail[i]] + width[edgetail[i]] * 0.5f * 1.8f);
+    }
+    graph.size = ImVec2(maxx - minx, maxy - miny);
+    graph.Reserve(count, edges.size(), submission.strings.size());
+    for (int i = 0; i < count; ++i)
+    {
+        ImGuiGraphNode_SubmittedNode const & submitted = submission.nodes[nodes[i]];
+
+        graph.AddNode(submitted.id, graph.AddString(submission.GetString(submitted.label)), ImVec2(posx[i] - minx, posy[i] - miny), ImVec2(width[i], height[i]), submitted.color, submitted.fillcolor);
+    }
+    for (int i = 0; i < (int)edges.size(); ++i)
+    {
+        ImGuiGraphNode_AddSubmittedEdge(graph, submission, submission.edges[edges[i]]);
+        if (edgetail[i] == edgehead[i])
+            ImGuiGraphNode_WriteLoopEdge(graph, edgetail[i]);
+        else
+            ImGuiGraphNode_WritePolylineEdge(graph, edgetail[i], edgehead[i], nullptr, 0);
+    }
+}
+
+void ImGuiGraphNodeRenderForceDirectedLayout(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission, ImGuiGraphNode_LayoutSeed const * seed)
+{
+    ImGuiGraphNode_ForceLayout layout;
+
+    layout.Init(submission, seed);
+    while (!layout.Step(16, 0))
+    {
+    }
+    layout.Write(graph, submission);
+}
+
+// Tree layout after Buchheim, Junger and Leipert's linear time version of
+// Walker's algorithm: subtrees are placed bottom up, each one next to its
+// left siblings and pushed away along their contours, which are followed
+// through threads. Ranks are stacked top down like with dot.
+
+#define IMGUI_GRAPHNODE_NODESEP 0.25f // dot defaults, in inches
+#define IMGUI_GRAPHNODE_RANKSEP 0.5f
+
+struct ImGuiGraphNode_TreeNode
+{
+    float prelim = 0.f;
+    float mod = 0.f;
+    float shift = 0.f;
+    float change = 0.f;
+    float midpoint = 0.f; // of the children, once they are placed
+    int parent = -1;
+    int number = 0; // index among siblings
+    int thread = -1;
+    int ancestor = 0;
+    int depth = 0;
+};
+
+struct ImGuiGraphNode_TreeLayout
+{
+    ImGuiGraphNode_Vector<ImGuiGraphNode_TreeNode> tree;
+    ImGuiGraphNode_Vector<int> offsets; // children of node v are children[offsets[v], offsets[v + 1])
+    ImGuiGraphNode_Vector<int> children;
+    ImGuiGraphNode_Vector<float> width;
+
+    int NextLeft(int v) const { return offsets[v] != offsets[v + 1] ? children[offsets[v]] : tree[v].thread; }
+    int NextRight(int v) const { return offsets[v] != offsets[v + 1] ? children[offsets[v + 1] - 1] : tree[v].thread; }
+    float Distance(int a, int b) const { return (width[a] + width[b]) * 0.5f + IMGUI_GRAPHNODE_NODESEP; }
+
+    void MoveSubtree(int wm, int wp, float shift)
+    {
+        float const subtrees = (float)(tree[wp].number - tree[wm].number);
+
+        tree[wp].change -= shift / subtrees;
+        tree[wp].shift += shift;
+        tree[wm].change += shift / subtrees;
+        tree[wp].prelim += shift;
+        tree[wp].mod += shift;
+    }
+
+    // Pushes the subtree of v right of its left siblings' subtrees, spreading
+    // the move over the siblings in between
+    int Apportion(int v, int default_ancestor)
+    {
+        if (tree[v].number == 0)
+            return default_ancestor;
+
+        int const first = offsets[tree[v].parent];
+        int vip = v;
+        int vop = v;
+        int vim = children[first + tree[v].number - 1];
+        int vom = children[first];
+        float sip = tree[vip].mod;
+        float sop = tree[vop].mod;
+        float sim = tree[vim].mod;
+        float som = tree[vom].mod;
+
+        while (NextRight(vim) >= 0 && NextLeft(vip) >= 0)
+        {
+            vim = NextRight(vim);
+            vip = NextLeft(vip);
+            vom = NextLeft(vom);
+            vop = NextRight(vop);
+            tree[vop].ancestor = v;
+
+            float const shift = (tree[vim].prelim + sim) - (tree[vip].prelim + sip) + Distance(vim, vip);
+
+            if (shift > 0.f)
+            {
+                int const ancestor = tree[tree[vim].ancestor].parent == tree[v].parent ? tree[vim].ancestor : default_ancestor;
+
+                MoveSubtree(ancestor, v, shift);
+                sip += shift;
+                sop += shift;
+            }
+            sim += tree[vim].mod;
+            sip += tree[vip].mod;
+            som += tree[vom].mod;
+            sop += tree[vop].mod;
+        }
+        if (NextRight(vim) >= 0 && NextRight(vop) < 0)
+        {
+            tree[vop].thread = NextRight(vim);
+            tree[vop].mod += sim - sop;
+        }
+        if (NextLeft(vip) >= 0 && NextLeft(vom) < 0)
+        {
+            tree[vom].thread = NextLeft(vip);
+            tree[vom].mod += sip - som;
+            default_ancestor = v;
+        }
+        return default_ancestor;
+    }
+
+    void ExecuteShifts(int v)
+    {
+        float shift = 0.f;
+        float change = 0.f;
+
+        for (int c = offsets[v + 1] - 1; c >= offsets[v]; --c)
+        {
+            ImGuiGraphNode_TreeNode & w = tree[children[c]];
+
+            w.prelim += shift;
+            w.mod += shift;
+            change += w.change;
+            shift += w.shift + change;
+        }
+    }
+};
+
+// Lays out the graph as a forest, children in edge submission order. Fails
+// when a node has several parents or lies on a cycle, an edge submitted again
+// between the same nodes doesn't count as another parent.
+bool ImGuiGraphNodeRenderTreeLayout(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission)
+{
+    ImGuiGraphNode_Vector<int> nodes;
+    ImGuiGraphNode_Vector<int> edges;
+    ImGuiGraphNode_Vector<int> edgetail;
+    ImGuiGraphNode_Vector<int> edgehead;
+
+    ImGuiGraphNode_CollectElements(submission, nodes, edges, edgetail, edgehead);
+
+    int const count = (int)nodes.size();
+    int const root = count; // virtual root above the roots of the forest
+    ImGuiGraphNode_TreeLayout layout;
+    ImGuiGraphNode_Vector<ImGuiGraphNode_TreeNode> & tree = layout.tree;
+
+    ImGuiGraphNode_Vector<int> treeedges; // first edge to each node, copies of it are only drawn
+
+    tree.resize(count + 1);
+    treeedges.reserve(edges.size());
+    for (int i = 0; i < (int)edges.size(); ++i)
+    {
+        int const parent = tree[edgehead[i]].parent;
+
+        if (parent == edgetail[i])
+            continue;
+        if (parent >= 0 || edgetail[i] == edgehead[i])
+            return false;
+        tree[edgehead[i]].parent = edgetail[i];
+        treeedges.push_back(i);
+    }
+    layout.offsets.assign(count + 2, 0);
+    for (int v = 0; v < count; ++v)
+    {
+        if (tree[v].parent < 0)
+            tree[v].parent = root;
+        ++layout.offsets[tree[v].parent + 1];
+    }
+    for (int v = 0; v <= count; ++v)
+        layout.offsets[v + 1] += layout.offsets[v];
+    layout.children.resize(count);
+    {
+        ImGuiGraphNode_Vector<int> fill(layout.offsets.begin(), layout.offsets.end() - 1);
+
+        for (int i : treeedges)
+            layout.children[fill[edgetail[i]]++] = edgehead[i];
+        for (int v = 0; v < count; ++v)
+        {
+            if (tree[v].parent == root)
+                layout.children[fill[root]++] = v;
+        }
+    }
+
+    // Breadth first order from the root, nodes left out are on a cycle
+    ImGuiGraphNode_Vector<int> order;
+
+    order.reserve(count + 1);
+    order.push_back(root);
+    tree[root].depth = -1;
+    for (int o = 0; o < (int)order.size(); ++o)
+    {
+        int const v = order[o];
+
+        for (int c = layout.offsets[v]; c < layout.offsets[v + 1]; ++c)
+        {
+            int const w = layout.children[c];
+
+            tree[w].number = c - layout.offsets[v];
+            tree[w].ancestor = w;
+            tree[w].depth = tree[v].depth + 1;
+            order.push_back(w);
+        }
+    }
+    if ((int)order.size() != count + 1)
+        return false;
+
+    ImGuiGraphNode_Vector<float> height(count + 1, 0.f);
+
+    layout.width.assign(count + 1, 0.f);
+    for (int v = 0; v < count; ++v)
+        ImGuiGraphNode_EstimateNodeSize(submission.GetString(submission.nodes[nodes[v]].label), &layout.width[v], &height[v]);
+
+    // First walk, bottom up: a node places its children once their own
+    // subtrees are laid out, relative to each other
+    for (int o = count; o >= 0; --o)
+    {
+        int const v = order[o];
+        int const begin = layout.offsets[v];
+        int const end = layout.offsets[v + 1];
+
+        if (begin == end)
+            continue;
+
+        int default_ancestor = layout.children[begin];
+
+        for (int c = begin; c < end; ++c)
+        {
+            int const w = layout.children[c];
+            bool const leaf = layout.offsets[w] == layout.offsets[w + 1];
+
+            if (c == begin)
+            {
+                tree[w].prelim = leaf ? 0.f : tree[w].midpoint;
+            }
+            else
+            {
+                int const sibling = layout.children[c - 1];
+
+                tree[w].prelim = tree[sibling].prelim + layout.Distance(sibling, w);
+                if (!leaf)
+                    tree[w].mod = tree[w].prelim - tree[w].midpoint;
+            }
+            default_ancestor = layout.Apportion(w, default_ancestor);
+        }
+        layout.ExecuteShifts(v);
+        tree[v].midpoint = (tree[layout.children[begin]].prelim + tree[layout.children[end - 1]].prelim) * 0.5f;
+    }
+
+    // Second walk, top down: mod accumulates the modifiers of a node and its
+    // ancestors, those of its ancestors only give its final x
+    ImGuiGraphNode_Vector<float> rankheight;
+    float minx = FLT_MAX;
+
+    tree[root].prelim = tree[root].midpoint;
+    tree[root].mod = 0.f;
+    for (int o = 1; o <= count; ++o)
+    {
+        int const v = order[o];
+        int const parent = tree[v].parent;
+        int const depth = tree[v].depth;
+
+        tree[v].mod += tree[parent].mod;
+        tree[v].prelim += tree[parent].mod;
+        if (depth >= (int)rankheight.size())
+            rankheight.resize(depth + 1, 0.f);
+        rankheight[depth] = ImMax(rankheight[depth], height[v]);
+        minx = ImMin(minx, tree[v].prelim - layout.width[v] * 0.5f);
+    }
+    ImGuiGraphNode_Vector<float> ranktop(rankheight.size() + 1, 0.f);
+    float maxx = -FLT_MAX;
+
+    for (int d = 0; d < (int)rankheight.size(); ++d)
+        ranktop[d + 1] = ranktop[d] + rankheight[d] + IMGUI_GRAPHNODE_RANKSEP;
+
+    float const total_height = rankheight.empty() ? 0.f : ranktop.back() - IMGUI_GRAPHNODE_RANKSEP;
+
+    graph.Clear();
+    graph.scale = 1.f;
+    graph.Reserve(count, edges.size(), submission.strings.size());
+    for (int v = 0; v < count; ++v)
+    {
+        ImGuiGraphNode_SubmittedNode const & submitted = submission.nodes[nodes[v]];
+        int const depth = tree[v].depth;
+        ImVec2 const pos(tree[v].prelim - minx, total_height - (ranktop[depth] + rankheight[depth] * 0.5f));
+
+        graph.AddNode(submitted.id, graph.AddString(submission.GetString(submitted.label)), pos, ImVec2(layout.width[v], height[v]), submitted.color, submitted.fillcolor);
+        maxx = ImMax(maxx, pos.x + layout.width[v] * 0.5f);
+    }
+    graph.size = ImVec2(count ? maxx : 0.f, total_height);
+    for (int i = 0; i < (int)edges.size(); ++i)
+    {
+        ImGuiGraphNode_AddSubmittedEdge(graph, submission, submission.edges[edges[i]]);
+        ImGuiGraphNode_WritePolylineEdge(graph, edgetail[i], edgehead[i], nullptr, 0);
+    }
+    return true;
+}
+
+// Layered layout after Sugiyama et al., a simpler and much faster take on
+// what dot does: cycles are broken by reversing the back edges of a depth
+// first search, nodes are ranked by longest path, edges spanning several
+// ranks are split by dummy nodes, the order within ranks is improved by
+// barycenter sweeps, and x coordinates are fitted to the neighbors' under
+// order and separation constraints. Edges are polylines through the dummies.
+
+#define IMGUI_GRAPHNODE_LAYERED_SWEEPS 12 // down and up sweep pairs per candidate ordering
+#define IMGUI_GRAPHNODE_LAYERED_CANDIDATES 4 // orderings reduced in parallel, the one with fewest crossings is kept
+#define IMGUI_GRAPHNODE_LAYERED_PARALLEL_MIN_NODES 1024 // nodes and dummies from which the candidates are reduced on separate threads
+#define IMGUI_GRAPHNODE_LAYERED_PLACEMENT_PASSES 8
+#define IMGUI_GRAPHNODE_LAYERED_DUMMY_WEIGHT 4.f // long edges are kept straight rather than nodes centered
+
+struct ImGuiGraphNode_LayeredGraph
+{
+    int count = 0; // real nodes, dummy nodes follow them
+    ImGuiGraphNode_Vector<int> rank;
+    ImGuiGraphNode_Vector<float> width;
+    ImGuiGraphNode_Vector<int> up_offsets; // neighbors of node v in the rank above are up[up_offsets[v], up_offsets[v + 1])
+    ImGuiGraphNode_Vector<int> up;
+    ImGuiGraphNode_Vector<int> down_offsets;
+    ImGuiGraphNode_Vector<int> down;
+    ImGuiGraphNode_Vector<int> rank_offsets; // nodes of rank r are ImGuiGraphNode_LayeredOrder::order[rank_offsets[r], rank_offsets[r + 1])
+};
+
+struct ImGuiGraphNode_LayeredOrder
+{
+    ImGuiGraphNode_Vector<int> order;
+    ImGuiGraphNode_Vector<int> position; // index of each node within its rank
+    long long crossings = 0;
+};
+
+// Orders rank r by the mean position of each node's neighbors in the
+// previous rank of the sweep, nodes without neighbors keep their position
+static void ImGuiGraphNode_SortRank(ImGuiGraphNode_LayeredGraph const & g, ImGuiGraphNode_LayeredOrder & o, int r, bool downward, ImGuiGraphNode_Vector<std::pair<float, int>> & keys)
+{
+    int const begin = g.rank_offsets[r];
+    int const end = g.rank_offsets[r + 1];
+    ImGuiGraphNode_Vector<int> const & neighbors = downward ? g.up : g.down;
+    ImGuiGraphNode_Vector<int> const & neighbor_offsets = downward ? g.up_offsets : g.down_offsets;
+
+    keys.clear();
+    for (int i = begin; i < end; ++i)
+    {
+        int const v = o.order[i];
+        int const nbegin = neighbor_offsets[v];
+        int const nend = neighbor_offsets[v + 1];
+        float key = (float)o.position[v];
+
+        if (nbegin != nend)
+        {
+            int sum = 0;
+
+            for (int n = nbegin; n < nend; ++n)
+                sum += o.position[neighbors[n]];
+            key = (float)sum / (float)(nend - nbegin);
+        }
+        keys.push_back(std::make_pair(key, v));
+    }
+    std::stable_sort(keys.begin(), keys.end(), [](std::pair<float, int> const & a, std::pair<float, int> const & b) { return a.first < b.first; });
+    for (int i = begin; i < end; ++i)
+    {
+        o.order[i] = keys[i - begin].second;
+        o.position[o.order[i]] = i - begin;
+    }
+}
+
+// Crossings between consecutive ranks, counted as inversions with a Fenwick
+// tree (Barth, Junger and Mutzel)
+static long long ImGuiGraphNode_CountCrossings(ImGuiGraphNode_LayeredGraph const & g, ImGuiGraphNode_LayeredOrder const & o, ImGuiGraphNode_Vector<int> & tree, ImGuiGraphNode_Vector<int> & targets)
+{
+    long long crossings = 0;
+
+    for (int r = 0; r + 2 < (int)g.rank_offsets.size(); ++r)
+    {
+        int const size = g.rank_offsets[r + 2] - g.rank_offsets[r + 1];
+        int inserted = 0;
+
+        tree.assign(size + 1, 0);
+        for (int i = g.rank_offsets[r]; i < g.rank_offsets[r + 1]; ++i)
+        {
+            int const v = o.order[i];
+
+            targets.clear();
+            for (int n = g.down_offsets[v]; n < g.down_offsets[v + 1]; ++n)
+                targets.push_back(o.position[g.down[n]]);
+            std::sort(targets.begin(), targets.end());
+            for (int p : targets)
+            {
+                int before = 0;
+
+                for (int x = p + 1; x > 0; x -= x & -x)
+                    before += tree[x];
+                crossings += inserted - before;
+                for (int x = p + 1; x <= size; x += x & -x)
+                    ++tree[x];
+                ++inserted;
+            }
+        }
+    }
+    return crossings;
+}
+
+static void ImGuiGraphNode_ReduceCrossings(ImGuiGraphNode_LayeredGraph const & g, ImGuiGraphNode_LayeredOrder & o, bool downward)
+{
+    int const ranks = (int)g.rank_offsets.size() - 1;
+    ImGuiGraphNode_Vector<std::pair<float, int>> keys;
+    ImGuiGraphNode_Vector<int> tree;
+    ImGuiGraphNode_Vector<int> targets;
+    ImGuiGraphNode_LayeredOrder best = o;
+    int stalled = 0;
+
+    best.crossings = ImGuiGraphNode_CountCrossings(g, o, tree, targets);
+    for (int sweep = 0; sweep < IMGUI_GRAPHNODE_LAYERED_SWEEPS * 2 && best.crossings > 0 && stalled < 4; ++sweep)
+    {
+        if (downward)
+        {
+            for (int r = 1; r < ranks; ++r)
+                ImGuiGraphNode_SortRank(g, o, r, true, keys);
+        }
+        else
+        {
+            for (int r = ranks - 2; r >= 0; --r)
+                ImGuiGraphNode_SortRank(g, o, r, false, keys);
+        }
+        downward = !downward;
+        o.crossings = ImGuiGraphNode_CountCrossings(g, o, tree, targets);
+        if (o.crossings < best.crossings)
+        {
+            best.order = o.order;
+            best.position = o.position;
+            best.crossings = o.crossings;
+            stalled = 0;
+        }
+        else
+        {
+            ++stalled;
+        }
+    }
+    o = std::move(best);
+}
+
+// Moves the nodes of rank r as close as possible to the mean x of their
+// neighbors, keeping their order and separation. This is a weighted isotonic
+// regression on x minus the minimal offset from the first node, solved
+// exactly by pooling adjacent violators.
+static void ImGuiGraphNode_PlaceRank(ImGuiGraphNode_LayeredGraph const & g, ImGuiGraphNode_LayeredOrder const & o, ImGuiGraphNode_Vector<float> & x, int r, bool use_up, bool use_down, ImGuiGraphNode_Vector<float> & offsets, ImGuiGraphNode_Vector<ImVec4> & blocks)
+{
+    int const begin = g.rank_offsets[r];
+    int const end = g.rank_offsets[r + 1];
+
+    offsets.resize(end - begin);
+    blocks.clear();
+    for (int i = begin; i < end; ++i)
+    {
+        int const v = o.order[i];
+        float sum = 0.f;
+        int n = 0;
+
+        if (use_up)
+        {
+            for (int a = g.up_offsets[v]; a < g.up_offsets[v + 1]; ++a, ++n)
+                sum += x[g.up[a]];
+        }
+        if (use_down)
+        {
+            for (int a = g.down_offsets[v]; a < g.down_offsets[v + 1]; ++a, ++n)
+                sum += x[g.down[a]];
+        }
+
+        float const target = n ? sum / n : x[v];
+        float const weight = n == 0 ? 0.1f : v >= g.count ? IMGUI_GRAPHNODE_LAYERED_DUMMY_WEIGHT : 1.f;
+        float const offset = i == begin ? 0.f : offsets[i - begin - 1] + (g.width[o.order[i - 1]] + g.width[v]) * 0.5f + IMGUI_GRAPHNODE_NODESEP;
+
+        offsets[i - begin] = offset;
+        // Block: weight, weighted sum of targets, first index, one past the last
+        blocks.push_back(ImVec4(weight, weight * (target - offset), (float)(i - begin), (float)(i - begin + 1)));
+        while (blocks.size() > 1)
+        {
+            ImVec4 const & prev = blocks[blocks.size() - 2];
+            ImVec4 const & last = blocks.back();
+
+            if (prev.y / prev.x < last.y / last.x)
+                break;
+
+            ImVec4 const merged(prev.x + last.x, prev.y + last.y, prev.z, last.w);
+
+            blocks.pop_back();
+            blocks.back() = merged;
+        }
+    }
+    for (auto const & block : blocks)
+    {
+        float const y = block.y / block.x;
+
+        for (int i = (int)block.z; i < (int)block.w; ++i)
+            x[o.order[begin + i]] = y + offsets[i];
+    }
+}
+
+void ImGuiGraphNodeRenderLayeredLayout(ImGuiGraphNode_Graph & graph, ImGuiGraphNode_Submission const & submission)
+{
+    ImGuiGraphNode_Vector<int> nodes;
+    ImGuiGraphNode_Vector<int> edges;
+    ImGuiGraphNode_Vector<int> edgetail;
+    ImGuiGraphNode_Vector<int> edgehead;
+
+    ImGuiGraphNode_CollectElements(submission, nodes, edges, edgetail, edgehead);
+
+    int const count = (int)nodes.size();
+    int const edge_count = (int)edges.size();
+    ImGuiGraphNode_LayeredGraph g;
+    ImGuiGraphNode_Vector<float> height(count);
+
+    g.count = count;
+    g.width.resize(count);
+    for (int v = 0; v < count; ++v)
+        ImGuiGraphNode_EstimateNodeSize(submission.GetString(submission.nodes[nodes[v]].label), &g.width[v], &height[v]);
+
+    // Out edges of each node, loops are left out of the ranking
+    ImGuiGraphNode_Vector<int> out_offsets(count + 1, 0);
+    ImGuiGraphNode_Vector<int> out;
+
+    for (int i = 0; i < edge_count; ++i)
+    {
+        if (edgetail[i] != edgehead[i])
+            ++out_offsets[edgetail[i] + 1];
+    }
+    for (int v = 0; v < count; ++v)
+        out_offsets[v + 1] += out_offsets[v];
+    out.resize(out_offsets[count]);
+    {
+        ImGuiGraphNode_Vector<int> fill(out_offsets.begin(), out_offsets.end() - 1);
+
+        for (int i = 0; i < edge_count; ++i)
+        {
+            if (edgetail[i] != edgehead[i])
+                out[fill[edgetail[i]]++] = i;
+        }
+    }
+
+    // Cycle removal: edges leading back to a node on the depth first search
+    // stack are reversed
+    ImGuiGraphNode_Vector<bool> reversed(edge_count, false);
+    {
+        ImGuiGraphNode_Vector<char> state(count, 0); // 0: unvisited, 1: on the stack, 2: done
+        ImGuiGraphNode_Vector<std::pair<int, int>> stack; // node, next out edge
+
+        for (int root = 0; root < count; ++root)
+        {
+            if (state[root])
+                continue;
+            state[root] = 1;
+            stack.push_back(std::make_pair(root, out_offsets[root]));
+            while (!stack.empty())
+            {
+                int const v = stack.back().first;
+                int & next = stack.back().second;
+
+                if (next == out_offsets[v + 1])
+                {
+                    state[v] = 2;
+                    stack.pop_back();
+                    continue;
+                }
+
+                int const e = out[next++];
+                int const w = edgehead[e];
+
+                if (state[w] == 1)
+                {
+                    reversed[e] = true;
+                }
+                else if (state[w] == 0)
+                {
+                    state[w] = 1;
+                    stack.push_back(std::make_pair(w, out_offsets[w]));
+                }
+            }
+        }
+    }
+
+    // Ranking by longest path from the sources, in topological order
+    ImGuiGraphNode_Vector<int> dagtail(edge_count);
+    ImGuiGraphNode_Vector<int> daghead(edge_count);
+    ImGuiGraphNode_Vector<int> indegree(count, 0);
+    ImGuiGraphNode_Vector<int> outdegree(count, 0);
+    ImGuiGraphNode_Vector<int> succ_offsets(count + 1, 0);
+    ImGuiGraphNode_Vector<int> succ;
+
+    for (int i = 0; i < edge_count; ++i)
+    {
+        dagtail[i] = reversed[i] ? edgehead[i] : edgetail[i];
+        daghead[i] = reversed[i] ? edgetail[i] : edgehead[i];
+        if (dagtail[i] == daghead[i])
+            continue;
+        ++indegree[daghead[i]];
+        ++outdegree[dagtail[i]];
+        ++succ_offsets[dagtail[i] + 1];
+    }
+    for (int v = 0; v < count; ++v)
+        succ_offsets[v + 1] += succ_offsets[v];
+    succ.resize(succ_offsets[count]);
+    {
+        ImGuiGraphNode_Vector<int> fill(succ_offsets.begin(), succ_offsets.end() - 1);
+
+        for (int i = 0; i < edge_count; ++i)
+        {
+            if (dagtail[i] != daghead[i])
+                succ[fill[dagtail[i]]++] = daghead[i];
+        }
+    }
+
+    ImGuiGraphNode_Vector<int> topo;
+    ImGuiGraphNode_Vector<int> remaining(indegree);
+
+    g.rank.assign(count, 0);
+    topo.reserve(count);
+    for (int v = 0; v < count; ++v)
+    {
+        if (remaining[v] == 0)
+            topo.push_back(v);
+    }
+    for (int t = 0; t < (int)topo.size(); ++t)
+    {
+        int const v = topo[t];
+
+        for (int s = succ_offsets[v]; s < succ_offsets[v + 1]; ++s)
+        {
+            int const w = succ[s];
+
+            g.rank[w] = ImMax(g.rank[w], g.rank[v] + 1);
+            if (--remaining[w] == 0)
+                topo.push_back(w);
+        }
+    }
+    IM_ASSERT((int)topo.size() == count);
+
+    // Nodes with more successors than predecessors move down next to their
+    // successors, which shortens more edges than it stretches
+    for (int t = count - 1; t >= 0; --t)
+    {
+        int const v = topo[t];
+
+        if (outdegree[v] <= indegree[v])
+            continue;
+
+        int closest = INT_MAX;
+
+        for (int s = succ_offsets[v]; s < succ_offsets[v + 1]; ++s)
+            closest = ImMin(closest, g.rank[succ[s]]);
+        g.rank[v] = closest - 1;
+    }
+
+    // Empty ranks are removed
+    int ranks = 0;
+    {
+        int max_rank = 0;
+
+        for (int v = 0; v < count; ++v)
+            max_rank = ImMax(max_rank, g.rank[v]);
+
+        ImGuiGraphNode_Vector<int> remap(max_rank + 1, 0);
+
+        for (int v = 0; v < count; ++v)
+            remap[g.rank[v]] = 1;
+        for (int r = 0; r <= max_rank; ++r)
+        {
+            int const used = remap[r];
+
+            remap[r] = ranks;
+            ranks += used;
+        }
+        for (int v = 0; v < count; ++v)
+            g.rank[v] = remap[g.rank[v]];
+    }
+
+    // Dummy nodes split edges spanning several ranks, chain_offsets gives
+    // the dummies of each edge from its top end
+    ImGuiGraphNode_Vector<int> chain_offsets(edge_count + 1, 0);
+
+    for (int i = 0; i < edge_count; ++i)
+    {
+        int const span = dagtail[i] != daghead[i] ? g.rank[daghead[i]] - g.rank[dagtail[i]] : 1;
+
+        chain_offsets[i + 1] = chain_offsets[i] + span - 1;
+    }
+
+    int const total = count + chain_offsets[edge_count];
+
+    g.rank.resize(total);
+    g.width.resize(total, 0.f);
+    for (int i = 0; i < edge_count; ++i)
+    {
+        for (int d = chain_offsets[i]; d < chain_offsets[i + 1]; ++d)
+            g.rank[count + d] = g.rank[dagtail[i]] + 1 + d - chain_offsets[i];
+    }
+
+    // Segments between consecutive ranks
+    ImGuiGraphNode_Vector<std::pair<int, int>> segments;
+
+    segments.reserve(edge_count + total - count);
+    for (int i = 0; i < edge_count; ++i)
+    {
+        if (dagtail[i] == daghead[i])
+            continue;
+
+        int prev = dagtail[i];
+
+        for (int d = chain_offsets[i]; d < chain_offsets[i + 1]; ++d)
+        {
+            segments.push_back(std::make_pair(prev, count + d));
+            prev = count + d;
+        }
+        segments.push_back(std::make_pair(prev, daghead[i]));
+    }
+    g.up_offsets.assign(total + 1, 0);
+    g.down_offsets.assign(total + 1, 0);
+    for (auto const & segment : segments)
+    {
+        ++g.down_offsets[segment.first + 1];
+        ++g.up_offsets[segment.second + 1];
+    }
+    for (int v = 0; v < total; ++v)
+    {
+        g.down_offsets[v + 1] += g.down_offsets[v];
+        g.up_offsets[v + 1] += g.up_offsets[v];
+    }
+    g.down.resize(segments.size());
+    g.up.resize(segments.size());
+    {
+        ImGuiGraphNode_Vector<int> down_fill(g.down_offsets.begin(), g.down_offsets.end() - 1);
+        ImGuiGraphNode_Vector<int> up_fill(g.up_offsets.begin(), g.up_offsets.end() - 1);
+
+        for (auto const & segment : segments)
+        {
+            g.down[down_fill[segment.first]++] = segment.second;
+            g.up[up_fill[segment.second]++] = segment.first;
+        }
+    }
+
+    // Initial order: real nodes in topological order, then dummies
+    ImGuiGraphNode_LayeredOrder initial;
+
+    g.rank_offsets.assign(ranks + 1, 0);
+    for (int v = 0; v < total; ++v)
+        ++g.rank_offsets[g.rank[v] + 1];
+    for (int r = 0; r < ranks; ++r)
+        g.rank_offsets[r + 1] += g.rank_offsets[r];
+    initial.order.resize(total);
+    initial.position.resize(total);
+    {
+        ImGuiGraphNode_Vector<int> fill(g.rank_offsets.begin(), g.rank_offsets.end() - 1);
+        auto const add = [&](int v)
+        {
+            initial.position[v] = fill[g.rank[v]] - g.rank_offsets[g.rank[v]];
+            initial.order[fill[g.rank[v]]++] = v;
+        };
+
+        for (int v : topo)
+            add(v);
+        for (int v = count; v < total; ++v)
+            add(v);
+    }
+
+    // Crossing reduction from several starting points, on separate threads
+    // for large graphs. Candidates start from the initial order or its
+    // mirror, sweeping down or up first.
+    ImGuiGraphNode_LayeredOrder candidates[IMGUI_GRAPHNODE_LAYERED_CANDIDATES];
+
+    for (int c = 0; c < IMGUI_GRAPHNODE_LAYERED_CANDIDATES; ++c)
+    {
+        candidates[c] = initial;
+        if (c & 2)
+        {
+            for (int r = 0; r < ranks; ++r)
+                std::reverse(candidates[c].order.begin() + g.rank_offsets[r], candidates[c].order.begin() + g.rank_offsets[r + 1]);
+            for (int i = 0; i < total; ++i)
+                candidates[c].position[candidates[c].order[i]] = i - g.rank_offsets[g.rank[candidates[c].order[i]]];
+        }
+    }
+    {
+        int const num_threads = total >= IMGUI_GRAPHNODE_LAYERED_PARALLEL_MIN_NODES ? IMGUI_GRAPHNODE_LAYERED_CANDIDATES : 1;
+
+        ImGuiGraphNode_ParallelFor(IMGUI_GRAPHNODE_LAYERED_CANDIDATES, num_threads, [&](int begin, int end, int)
+        {
+            for (int c = begin; c < end; ++c)
+                ImGuiGraphNode_ReduceCrossings(g, candidates[c], (c & 1) == 0);
+        }, 1);
+    }
+
+    int chosen = 0;
+
+    for (int c = 1; c < IMGUI_GRAPHNODE_LAYERED_CANDIDATES; ++c)
+    {
+        if (candidates[c].crossings < candidates[chosen].crossings)
+            chosen = c;
+    }
+
+    ImGuiGraphNode_LayeredOrder const & o = candidates[chosen];
+
+    // Coordinate assignment: ranks packed and centered, then alternately
+    // fitted to the rank above and below, and finally to both
+    ImGuiGraphNode_Vector<float> x(total, 0.f);
+    ImGuiGraphNode_Vector<float> offsets;
+    ImGuiGraphNode_Vector<ImVec4> blocks;
+
+    for (int r = 0; r < ranks; ++r)
+    {
+        float pos = 0.f;
+
+        for (int i = g.rank_offsets[r]; i < g.rank_offsets[r + 1]; ++i)
+        {
+            int const v = o.order[i];
+
+            if (i != g.rank_offsets[r])
+                pos += (g.width[o.order[i - 1]] + g.width[v]) * 0.5f + IMGUI_GRAPHNODE_NODESEP;
+            x[v] = pos;
+        }
+        for (int i = g.rank_offsets[r]; i < g.rank_offsets[r + 1]; ++i)
+            x[o.order[i]] -= pos * 0.5f;
+    }
+    for (int pass = 0; pass < IMGUI_GRAPHNODE_LAYERED_PLACEMENT_PASSES; ++pass)
+    {
+        for (int r = 1; r < ranks; ++r)
+            ImGuiGraphNode_PlaceRank(g, o, x, r, true, false, offsets, blocks);
+        for (int r = ranks - 2; r >= 0; --r)
+            ImGuiGraphNode_PlaceRank(g, o, x, r, false, true, offsets, blocks);
+    }
+    for (int r = 0; r < ranks; ++r)
+        ImGuiGraphNode_PlaceRank(g, o, x, r, true, true, offsets, blocks);
+
+    // Ranks are stacked top down, y grows upwards like with graphviz
+    ImGuiGraphNode_Vector<float> rankheight(ranks, 0.f);
+    ImGuiGraphNode_Vector<float> ranktop(ranks + 1, 0.f);
+
+    for (int v = 0; v < count; ++v)
+        rankheight[g.rank[v]] = ImMax(rankheight[g.rank[v]], height[v]);
+    for (int r = 0; r < ranks; ++r)
+        ranktop[r + 1] = ranktop[r] + rankheight[r] + IMGUI_GRAPHNODE_RANKSEP;
+
+    float const total_height = ranks ? ranktop[ranks] - IMGUI_GRAPHNODE_RANKSEP : 0.f;
+    auto const rank_y = [&](int r) { return total_height - (ranktop[r] + rankheight[r] * 0.5f); };
+    float minx = FLT_MAX;
+    float maxx = -FLT_MAX;
+
+    for (int v = 0; v < total; ++v)
+    {
+        minx = ImMin(minx, x[v] - g.width[v] * 0.5f);
+        maxx = ImMax(maxx, x[v] + g.width[v] * 0.5f);
+    }
+    for (int i = 0; i < edge_count; ++i)
+    {
+        if (edgetail[i] == edgehead[i])
+            maxx = ImMax(maxx, x[edgetail[i]] + g.width[edgetail[i]] * 0.5f * 1.8f);
+    }
+
+    graph.Clear();
+    graph.scale = 1.f;
+    graph.size = count ? ImVec2(maxx - minx, total_height) : ImVec2(0.f, 0.f);
+    graph.Reserve(count, edge_count, submission.strings.size());
+    for (int v = 0; v < count; ++v)
+    {
+        ImGuiGraphNode_SubmittedNode const & submitted = submission.nodes[nodes[v]];
+
+        graph.AddNode(submitted.id, graph.AddString(submission.GetString(submitted.label)), ImVec2(x[v] - minx, rank_y(g.rank[v])), ImVec2(g.width[v], height[v]), submitted.color, submitted.fillcolor);
+    }
+
+    ImGuiGraphNode_Vector<ImVec2> bends;
+
+    for (int i = 0; i < edge_count; ++i)
+    {
+        ImGuiGraphNode_AddSubmittedEdge(graph, submission, submission.edges[edges[i]]);
+        if (edgetail[i] == edgehead[i])
+        {
+            ImGuiGraphNode_WriteLoopEdge(graph, edgetail[i]);
+            continue;
+        }
+        bends.clear();
+        for (int d = chain_offsets[i]; d < chain_offsets[i + 1]; ++d)
+            bends.push_back(ImVec2(x[count + d] - minx, rank_y(g.rank[count + d])));
+        // Reversed edges still point from their tail to their head
+        if (reversed[i])
+            std::reverse(bends.begin(), bends.end());
+        ImGuiGraphNode_WritePolylineEdge(graph, edgetail[i], edgehead[i], bends.data(), (int)bends.size());
+    }
+}